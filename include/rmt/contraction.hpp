@@ -0,0 +1,79 @@
+/**
+ * @file        contraction.hpp
+ *
+ * @brief       Declaration of class rmt::ContractionHierarchy.
+ *
+ * @details     This file contains the declaration of an index for answering exact
+ *              shortest path distance queries on a rmt::Graph much faster than with
+ *              a plain Dijkstra traversal.
+ *
+ * @author      agent (agent@local)
+ *
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <rmt/graph.hpp>
+#include <string>
+#include <vector>
+
+
+namespace rmt
+{
+
+/**
+ * @brief       Contraction hierarchy of a rmt::Graph.
+ *
+ * @details     The nodes of the graph are contracted one at a time, in the order given by
+ *              their edge difference and by the number of their already contracted neighbors.
+ *              Contracting a node adds a shortcut between each pair of its neighbors, unless
+ *              a local witness search finds a path that is not longer. The witness search
+ *              is bounded in the number of settled nodes and of edges on its paths, so it can
+ *              only add superfluous shortcuts and never misses a needed one. After each
+ *              contraction, only the priorities of the neighbors of the node are estimated
+ *              again, with a cheaper witness search, when they reach the top of the queue.\n
+ *              The index stores, for each node, the edges and the shortcuts towards the nodes
+ *              contracted after it, in compressed sparse row format. A distance query is a
+ *              bidirectional Dijkstra that only moves upwards in the hierarchy, and visits a
+ *              small fraction of the graph.\n
+ *              Distances are exact, up to the rounding of the sums of the edge weights, which
+ *              can be associated differently than in rmt::Graph::DijkstraPath().\n
+ *              The index can be saved to and loaded from a binary file, so that it is built
+ *              only once for each graph. The file records the number of nodes and edges of the
+ *              graph, and Load() fails if they do not match the given graph or if the file is
+ *              corrupted, leaving the hierarchy untouched. Save() writes a temporary file and
+ *              renames it over the old one.\n
+ *              Meshes do not have the strong hierarchy of road networks: the top levels of the
+ *              hierarchy are dense, and the advantage over a plain Dijkstra grows slowly with
+ *              the size of the graph. Most of the construction goes into the last few percent
+ *              of the contractions, and a query is only two to three times faster than
+ *              rmt::Graph::DijkstraPath(). For this reason the index is not included by
+ *              rmt.hpp, and must be included explicitly.
+ */
+class ContractionHierarchy
+{
+private:
+    std::vector<int> m_Rank;
+    std::vector<int> m_Idxs;
+    std::vector<int> m_Adjs;
+    std::vector<double> m_Wgts;
+    int m_NGraphEdges;
+
+public:
+    ContractionHierarchy();
+    ContractionHierarchy(const rmt::Graph& G);
+    ~ContractionHierarchy();
+
+    void Build(const rmt::Graph& G);
+    bool Save(const std::string& Filename) const;
+    bool Load(const std::string& Filename, const rmt::Graph& G);
+
+    int NumVertices() const;
+    int NumEdges() const;
+    int GetRank(int i) const;
+
+    double Distance(int src, int dst) const;
+    double Distance(int src, int dst, rmt::DijkstraWorkspace& Fwd, rmt::DijkstraWorkspace& Bwd) const;
+};
+
+} // namespace rmt
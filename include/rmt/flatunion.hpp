@@ -16,10 +16,29 @@
 #include <rmt/voronoifps.hpp>
 #include <rmt/region.hpp>
 #include <rmt/utils.hpp>
+#include <rmt/parallel.hpp>
+#include <string>
+#include <tuple>
 
 namespace rmt
 {
 
+/**
+ * @brief       Verifies and enforces the flat union property of a rmt::VoronoiPartitioning.
+ *
+ * @details     Each iteration of the refinement loop only updates the regions that contain a cell
+ *              changed by the samples of the previous iteration, as reported by the partitioning. The
+ *              other regions have the same vertices, edges and triangles as before, so they cannot
+ *              have new issues. The faces of the changed cells are visited to find their regions, and
+ *              the vertices, edges and triangles of all the cells of those regions are counted again,
+ *              so the cost of an iteration depends on the changed area and not on the mesh.\n
+ *              When more than half of the cells changed, as on the first iteration, the whole mesh is
+ *              visited instead. Both ways insert exactly the same samples.\n
+ *              The faces are split into contiguous ranges, one for each thread. The first range
+ *              updates the regions directly, while the others collect them apart and are merged in
+ *              order, so the regions, their breakpoints and their midpoints are the same as with a
+ *              single thread.
+ */
 class FlatUnion
 {
 private:
@@ -27,24 +46,71 @@ private:
     rmt::VoronoiPartitioning& m_VPart;
     rmt::RegionDictionary m_RDict;
 
-    std::unordered_map<std::tuple<int, int, int>,
-                       std::vector<int>,
-                       rmt::TripleHash<int>> m_Midpoints;
+    rmt::FlatHashMap<rmt::PackedTriple, std::vector<int>> m_Midpoints;
 
-    std::unordered_map<std::pair<int, int>,
-                       std::pair<int, double>,
-                       rmt::PairHash<int>> m_BoundBreak;
+    rmt::FlatHashMap<std::uint64_t, std::pair<int, double>> m_BoundBreak;
 
     std::vector<std::pair<int, double>> m_Farthests;
 
+    int m_Iterations;
+
+    // Faces incident to each vertex, in compressed sparse row format
+    std::vector<int> m_VFIdx;
+    std::vector<int> m_VFAdj;
+
+    // State of the incremental updates: the changed cells and the cells to count again
+    bool m_Incremental;
+    std::vector<bool> m_Dirty;
+    std::vector<int> m_ScanCells;
+    std::vector<bool> m_Scan;
+    std::vector<int> m_Faces;
+
+    // Regions found by a thread other than the first one, in the order of its faces
+    struct FaceRegions
+    {
+        std::vector<std::pair<int, double>> Farthests;
+        rmt::FlatHashMap<std::uint64_t, std::pair<int, double>> BoundBreak;
+        rmt::FlatHashMap<rmt::PackedTriple, std::vector<int>> Midpoints;
+        std::vector<std::tuple<int, int, int>> Regions;
+    };
+
+    rmt::ThreadPool m_Pool;
+    std::vector<FaceRegions> m_Local;
+
+    void BuildIncidence();
+    void AddFace(int i, FaceRegions* Local);
+    void AddFaces();
+    void ComputeChangedTopologies();
+
 public:
+    /**
+     * @param M             The mesh.
+     * @param VPart         The partitioning to refine.
+     * @param NumThreads    The number of threads, zero to use all the hardware threads. Small meshes
+     *                      are processed on the calling thread.
+     */
     FlatUnion(const rmt::Mesh& M,
-              rmt::VoronoiPartitioning& VPart);
+              rmt::VoronoiPartitioning& VPart,
+              int NumThreads = 0);
     ~FlatUnion();
 
     void DetermineRegions();
     void ComputeTopologies();
     bool FixIssues();
+
+    int NumIterations() const;
+
+    /**
+     * @brief       Binary checkpoint of the refinement loop.
+     *
+     * @details     Between two iterations, the whole state of the loop is the sampling, so the file
+     *              contains the number of calls to FixIssues() followed by the checkpoint of the
+     *              rmt::VoronoiPartitioning, with the same alignment. Load() restores both, and the
+     *              loop can continue with DetermineRegions(). As for the sampling, the checkpoint is
+     *              replaced only once the new one is completely written.
+     */
+    bool Save(const std::string& Filename) const;
+    bool Load(const std::string& Filename);
 };
     
 } // namespace rmt
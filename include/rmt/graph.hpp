@@ -15,12 +15,41 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <rmt/queue.hpp>
+#include <rmt/parallel.hpp>
 #include <vector>
 #include <set>
+#include <limits>
 
 namespace rmt
 {
 
+/**
+ * @brief       Scalar type used to store the edge weights of a graph.
+ * 
+ * @details     Weights are stored in double precision, unless the library is compiled
+ *              with RMT_FLOAT_EDGE_WEIGHTS defined, in which case they are stored in single
+ *              precision. Distances are always accumulated in double precision.
+ */
+#ifdef RMT_FLOAT_EDGE_WEIGHTS
+typedef float EdgeWeight;
+#else
+typedef double EdgeWeight;
+#endif
+
+/**
+ * @brief       Type used to store the positions of the nodes of a graph.
+ * 
+ * @details     Positions are stored in double precision, unless the library is compiled
+ *              with RMT_FLOAT_VERTEX_POSITIONS defined, in which case they are stored in single
+ *              precision. Lengths and distances computed from them are still in double precision.
+ */
+#ifdef RMT_FLOAT_VERTEX_POSITIONS
+typedef Eigen::Vector3f NodePosition;
+#else
+typedef Eigen::Vector3d NodePosition;
+#endif
+
 /**
  * @brief       Weighted edge of a graph.
  * 
@@ -36,6 +65,50 @@ typedef std::pair<int, double> WEdge;
  */
 typedef std::pair<double, std::vector<rmt::WEdge>> Path;
 
+/**
+ * @brief       Reusable memory for the shortest path queries of a rmt::Graph.
+ * 
+ * @details     A workspace holds the distances and the parents of the nodes reached by a
+ *              query, together with the buffers of the priority queues.\n
+ *              Distances and parents are stamped with the epoch of the query that wrote
+ *              them, and a new query simply increments the epoch instead of resetting the
+ *              arrays. Hence, once the workspace has been sized for a graph, repeated queries
+ *              cost time proportional to the part of the graph they visit.\n
+ *              Nodes can also be marked as settled, for the traversals that must not
+ *              expand a node twice.\n
+ *              A workspace can be shared by different graphs, but not by concurrent queries.
+ */
+class DijkstraWorkspace
+{
+private:
+    std::vector<double> m_Dists;
+    std::vector<int> m_Parents;
+    std::vector<unsigned int> m_Stamps;
+    std::vector<unsigned int> m_Settled;
+    unsigned int m_Epoch;
+
+    rmt::BinaryHeapQueue m_BinaryQ;
+    rmt::RadixHeapQueue m_RadixQ;
+
+public:
+    DijkstraWorkspace();
+    DijkstraWorkspace(int NumVertices);
+    ~DijkstraWorkspace();
+
+    void Reset(int NumVertices);
+    int Capacity() const;
+
+    bool IsReached(int i) const;
+    double GetDistance(int i) const;
+    int GetParent(int i) const;
+    void SetDistance(int i, double Dist, int Parent);
+    bool IsSettled(int i) const;
+    void Settle(int i);
+
+    rmt::BinaryHeapQueue& GetBinaryHeap();
+    rmt::RadixHeapQueue& GetRadixHeap();
+};
+
 /**
  * @brief       A graph-like data structure.
  * 
@@ -46,14 +119,27 @@ typedef std::pair<double, std::vector<rmt::WEdge>> Path;
 class Graph
 {
 private:
-    // std::vector<Eigen::Vector3d> m_Verts;
+    std::vector<rmt::NodePosition> m_Verts;
+    // The neighbors of node i are in m_Adjs[m_Idxs[i]:m_Idxs[i + 1]], and their weights
+    // in the same range of m_Wgts
     std::vector<int> m_Idxs;
-    std::vector<WEdge> m_Adjs;
+    std::vector<int> m_Adjs;
+    std::vector<rmt::EdgeWeight> m_Wgts;
+    rmt::QueueEngine m_Engine;
+
+    void ComputeWeights(rmt::ThreadPool& Pool);
+    void StoreVertices(const Eigen::MatrixXd& V);
 
 public:
-    Graph(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F);
-    Graph(const Eigen::MatrixXd& V, const std::vector<std::pair<int, int>>& E);
-    Graph(const Eigen::MatrixXd& V, const std::set<std::pair<int, int>>& E);
+    /**
+     * @brief       Builds the graph of the edges of a triangle mesh, or of a list of edges.
+     *
+     * @details     The adjacency is built with a counting sort of the incidences, using NumThreads
+     *              threads, zero for all the hardware threads. Small inputs are built on the calling thread.
+     */
+    Graph(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, int NumThreads = 1);
+    Graph(const Eigen::MatrixXd& V, const std::vector<std::pair<int, int>>& E, int NumThreads = 1);
+    Graph(const Eigen::MatrixXd& V, const std::set<std::pair<int, int>>& E, int NumThreads = 1);
     Graph(const rmt::Graph& G);
     Graph& operator=(const rmt::Graph& G);
     Graph(rmt::Graph&& G);
@@ -63,18 +149,85 @@ public:
     int NumVertices() const;
     int NumAdjacents(int i) const;
     int NumEdges() const;
+    double MeanEdgeLength() const;
+
+    const rmt::NodePosition& GetVertex(int i) const;
+    const std::vector<rmt::NodePosition>& GetVertices() const;
 
-    // const Eigen::Vector3d& GetVertex(int i) const;
-    // const std::vector<Eigen::Vector3d>& GetVertices() const;
+    WEdge GetAdjacent(int node_i, int adj_i) const;
+    int GetNeighbor(int node_i, int adj_i) const;
+    double GetWeight(int node_i, int adj_i) const;
 
-    const WEdge& GetAdjacent(int node_i, int adj_i) const;
+    /**
+     * @brief       The priority queue of all the traversals, a monotone radix heap by default.
+     */
+    rmt::QueueEngine GetQueueEngine() const;
+    void SetQueueEngine(rmt::QueueEngine Engine);
 
+    /**
+     * @brief       Shortest path from src to dst.
+     *
+     * @details     The overloads with a rmt::DijkstraWorkspace reuse its memory, so that repeated
+     *              queries only cost as much as the part of the graph they visit.
+     */
     rmt::Path DijkstraPath(int src, int dst) const;
+    rmt::Path DijkstraPath(int src, int dst, rmt::DijkstraWorkspace& W) const;
+    /**
+     * @brief       Same as DijkstraPath(), with a bidirectional search or with A* guided by the
+     *              Euclidean distance to dst. The lengths are equal up to rounding.
+     */
+    rmt::Path BidirectionalDijkstraPath(int src, int dst) const;
+    rmt::Path BidirectionalDijkstraPath(int src, int dst, rmt::DijkstraWorkspace& Fwd,
+                                        rmt::DijkstraWorkspace& Bwd) const;
+    rmt::Path AStarPath(int src, int dst) const;
+    rmt::Path AStarPath(int src, int dst, rmt::DijkstraWorkspace& W) const;
+    /**
+     * @brief       Answers a batch of queries in parallel with A*, with one workspace per thread.
+     */
+    std::vector<rmt::Path> ShortestPaths(const std::vector<std::pair<int, int>>& Queries,
+                                         int NumThreads = 0) const;
+    /**
+     * @brief       Distances of all the nodes from src.
+     *
+     * @details     The overload with Delta uses multithreaded delta-stepping, whose result is bitwise
+     *              identical to the sequential one. A non-positive Delta defaults to the mean edge length.
+     */
     Eigen::VectorXd DijkstraDistance(int src) const;
     void DijkstraDistance(int src, Eigen::VectorXd& Distances) const;
+    void DijkstraDistance(int src, Eigen::VectorXd& Distances, double Delta, int NumThreads = 0) const;
+    /**
+     * @brief       Distance of each node from the closest source, and index of that source in Sources.
+     *
+     * @details     Ties go to the source with the smallest index, so the labels do not depend on the
+     *              number of threads. Unreachable nodes have infinite distance and label -1.
+     */
+    void MultiSourceDijkstra(const std::vector<int>& Sources, Eigen::VectorXd& Distances,
+                             Eigen::VectorXi& Labels) const;
+    void MultiSourceDijkstra(const std::vector<int>& Sources, Eigen::VectorXd& Distances,
+                             Eigen::VectorXi& Labels, double Delta, int NumThreads = 0) const;
+    /**
+     * @brief       Nodes within MaxDist from src, or the given targets within it, as (node, distance)
+     *              pairs sorted by increasing distance.
+     */
+    std::vector<rmt::WEdge> DijkstraBounded(int src, double MaxDist) const;
+    std::vector<rmt::WEdge> DijkstraBounded(int src, double MaxDist, rmt::DijkstraWorkspace& W) const;
+    std::vector<rmt::WEdge> DijkstraTargets(int src, const std::vector<int>& Targets,
+                                            double MaxDist = std::numeric_limits<double>::infinity()) const;
+    std::vector<rmt::WEdge> DijkstraTargets(int src, const std::vector<int>& Targets, double MaxDist,
+                                            rmt::DijkstraWorkspace& W) const;
     int FarthestFiltered(int src, const std::vector<int>& Tag, int Filter) const;
+    int FarthestFiltered(int src, const std::vector<int>& Tag, int Filter,
+                         rmt::DijkstraWorkspace& W) const;
     int FarthestAtBoundary(int src, const std::vector<int>& Tag, int Region, int Neighbor) const;
+    int FarthestAtBoundary(int src, const std::vector<int>& Tag, int Region, int Neighbor,
+                           rmt::DijkstraWorkspace& W) const;
+    /**
+     * @brief       Component of each node, computed in parallel with a lock-free union-find.
+     *
+     * @details     Components are numbered by their node with the smallest index.
+     */
     std::vector<int> ConnectedComponents() const;
+    std::vector<int> ConnectedComponents(std::vector<int>& Sizes, int NumThreads = 0) const;
 };
 
 } // namespace rmt
@@ -0,0 +1,107 @@
+/**
+ * @file        parallel.hpp
+ *
+ * @brief       Minimal utilities for multithreaded loops.
+ *
+ * @details     This file contains the declaration of a persistent pool of threads and of
+ *              a parallel loop over a range of indices built on top of it.
+ *
+ * @author      agent (agent@local)
+ *
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+
+namespace rmt
+{
+
+/**
+ * @brief       Number of threads used when the caller does not specify it.
+ *
+ * @return      The number of hardware threads, or one if it cannot be determined.
+ */
+int DefaultNumThreads();
+
+
+/**
+ * @brief       Number of threads worth using for a loop over NumItems items.
+ *
+ * @details     NumThreads is resolved as in the constructor of rmt::ThreadPool, so zero means all
+ *              the hardware threads, and it is then reduced until every thread gets at least
+ *              MinItemsPerThread items. Small inputs thus get a single thread and spawn nothing.
+ */
+int NumThreadsFor(int NumThreads, long long NumItems, long long MinItemsPerThread = 16384);
+
+
+/**
+ * @brief       A persistent pool of threads.
+ *
+ * @details     The pool runs the same task on all its threads and waits for their
+ *              completion. The calling thread takes part to the execution as the
+ *              thread with index zero, so a pool with a single thread does not spawn
+ *              anything.\n
+ *              Threads are kept alive between two calls of Run(), which makes the
+ *              pool suitable for algorithms with many short synchronized phases.
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_StartCV;
+    std::condition_variable m_DoneCV;
+    std::function<void(int)> m_Task;
+    size_t m_Generation;
+    int m_Pending;
+    bool m_Stop;
+
+    void WorkerLoop(int ThreadID);
+
+public:
+    ThreadPool(int NumThreads = 0);
+    ThreadPool(const rmt::ThreadPool&) = delete;
+    rmt::ThreadPool& operator=(const rmt::ThreadPool&) = delete;
+    ~ThreadPool();
+
+    int NumThreads() const;
+    void Run(const std::function<void(int)>& Task);
+};
+
+
+/**
+ * @brief       Splits the range [Begin, End) into contiguous chunks, one for each thread
+ *              of the pool, and executes Body(ThreadID, ChunkBegin, ChunkEnd) on them.
+ *
+ * @details     Chunks are assigned in order, so chunk i always precedes chunk i + 1 in the
+ *              range. This allows merging per-thread results deterministically.
+ */
+template<typename Func>
+void ParallelFor(rmt::ThreadPool& Pool, int Begin, int End, Func&& Body)
+{
+    int NThreads = Pool.NumThreads();
+    int Size = std::max(End - Begin, 0);
+    if (NThreads == 1 || Size < NThreads)
+    {
+        Body(0, Begin, End);
+        for (int t = 1; t < NThreads; ++t)
+            Body(t, End, End);
+        return;
+    }
+
+    Pool.Run([&](int ThreadID)
+    {
+        int ChunkBegin = Begin + (int)(((long long)Size * ThreadID) / NThreads);
+        int ChunkEnd = Begin + (int)(((long long)Size * (ThreadID + 1)) / NThreads);
+        Body(ThreadID, ChunkBegin, ChunkEnd);
+    });
+}
+
+} // namespace rmt
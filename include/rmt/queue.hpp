@@ -0,0 +1,145 @@
+/**
+ * @file        queue.hpp
+ *
+ * @brief       Priority queues used by the shortest path traversals of rmt::Graph.
+ *
+ * @details     This file contains the declaration of the priority queues that can be used
+ *              as engines for the Dijkstra-like traversals of a rmt::Graph.\n
+ *              All the queues share the same minimal interface (Push(), Pop(), Empty(),
+ *              Clear() and Reserve()), so that the traversals can be written once and
+ *              instantiated for each engine.
+ *
+ * @author      agent (agent@local)
+ *
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace rmt
+{
+
+/**
+ * @brief       Engines available for the priority queues of the Dijkstra traversals.
+ *
+ * @details     BinaryHeap is a binary heap with lazy deletion, equivalent to a
+ *              std::priority_queue. RadixHeap is a monotone radix heap, which exploits
+ *              the fact that the extracted keys never decrease during a Dijkstra traversal
+ *              with non-negative weights.
+ */
+enum class QueueEngine
+{
+    BinaryHeap,
+    RadixHeap
+};
+
+
+/**
+ * @brief       Binary min-heap of (distance, node) pairs.
+ *
+ * @details     Ties are broken by the smallest node index, exactly as a
+ *              std::priority_queue<std::pair<double, int>> with std::greater.
+ */
+class BinaryHeapQueue
+{
+private:
+    std::vector<std::pair<double, int>> m_Heap;
+
+public:
+    BinaryHeapQueue();
+    ~BinaryHeapQueue();
+
+    bool Empty() const;
+    size_t Size() const;
+    void Clear();
+    void Reserve(size_t Capacity);
+
+    void Push(double Key, int Node);
+    std::pair<double, int> Pop();
+};
+
+
+/**
+ * @brief       Monotone radix heap of (distance, node) pairs.
+ *
+ * @details     A radix heap requires that every pushed key is not smaller than the last
+ *              extracted one, which is always the case for Dijkstra with non-negative weights.\n
+ *              Non-negative IEEE-754 doubles are ordered as their bit patterns, so the keys
+ *              are bucketed according to the most significant bit in which they differ from
+ *              the last extracted key. Each element is moved at most 64 times, and pushing
+ *              is a constant time operation.\n
+ *              Extracted keys are exactly the ones extracted by a BinaryHeapQueue, but the
+ *              order among nodes with identical keys is unspecified.
+ */
+class RadixHeapQueue
+{
+private:
+    std::vector<std::pair<uint64_t, int>> m_Buckets[65];
+    uint64_t m_Last;
+    size_t m_Size;
+
+    static uint64_t ToBits(double Key);
+    static double FromBits(uint64_t Bits);
+    int BucketIndex(uint64_t Bits) const;
+
+public:
+    RadixHeapQueue();
+    ~RadixHeapQueue();
+
+    bool Empty() const;
+    size_t Size() const;
+    void Clear();
+    void Reserve(size_t Capacity);
+
+    void Push(double Key, int Node);
+    std::pair<double, int> Pop();
+};
+
+
+/**
+ * @brief       Indexed 4-ary max-heap of (key, node) pairs.
+ *
+ * @details     Every node appears exactly once and its position is tracked, so that its key
+ *              can be decreased in place instead of pushing a duplicate. Ties are broken by the
+ *              smallest node index.\n
+ *              The four children of a node are contiguous in memory, and the heap is half as
+ *              deep as a binary one, which makes sifting down cheaper.
+ */
+class IndexedMaxHeap
+{
+private:
+    std::vector<std::pair<double, int>> m_Heap;
+    std::vector<int> m_Pos;
+
+    static bool Precedes(const std::pair<double, int>& A, const std::pair<double, int>& B);
+    void SiftUp(int i);
+    void SiftDown(int i);
+
+public:
+    IndexedMaxHeap();
+    ~IndexedMaxHeap();
+
+    void Build(const double* Keys, int NumNodes);
+
+    bool Empty() const;
+    size_t Size() const;
+    std::pair<double, int> Top() const;
+    double GetKey(int Node) const;
+
+    /**
+     * @brief       Inserts a node that is not in the heap yet.
+     */
+    void Push(double Key, int Node);
+
+    /**
+     * @brief       Lowers the key of Node to Key. Nothing happens if Key is not smaller than the current key.
+     */
+    void DecreaseKey(int Node, double Key);
+};
+
+} // namespace rmt
@@ -13,8 +13,7 @@
 
 #include <Eigen/Dense>
 #include <vector>
-#include <unordered_map>
-#include <unordered_set>
+#include <tuple>
 #include <rmt/utils.hpp>
 
 
@@ -30,7 +29,7 @@ private:
     // int m_NEdges;
     // // The number of faces in the region
     // int m_NFaces;
-    int m_chi;
+    // The Euler characteristic is counted by rmt::RegionDictionary
 
     // Samples generating the regions
     std::tuple<int, int, int> m_Samples;
@@ -47,13 +46,6 @@ public:
     // int NumVertices() const;
     // int NumEdges() const;
     // int NumFaces() const;
-    int EulerCharacteristic() const;
-
-    void AddFace();
-    // void AddBoundaryFace();
-    void AddEdge();
-    // void AddBoundaryEdge();
-    void AddVertex();
 
     friend bool operator==(const rmt::SurfaceRegion& SR1, const rmt::SurfaceRegion& SR3);
     friend bool operator!=(const rmt::SurfaceRegion& SR1, const rmt::SurfaceRegion& SR3);
@@ -76,22 +68,27 @@ class RegionDictionary
 private:
     // Vector of regions as unions of three Voronoi regions
     std::vector<rmt::SurfaceRegion> m_Regions;
-    std::unordered_set<std::tuple<int, int, int>, rmt::TripleHash<int>> m_RegSamples;
-
-    // Map samples into regions containing them
-    std::vector<std::vector<int>> m_VMap;
-
-    // Map couples of samples into regions containing at least one
-    std::unordered_map<std::pair<int, int>, 
-                       std::vector<int>,
-                       rmt::PairHash<int>> m_EMap;
-    std::unordered_set<std::pair<int, int>, rmt::PairHash<int>> m_ESet;
-
-    // Map triples of samples into regions containing at least one
-    std::unordered_map<std::tuple<int, int, int>,
-                       std::vector<int>,
-                       rmt::TripleHash<int>> m_TMap;
-    std::unordered_set<std::tuple<int, int, int>, rmt::TripleHash<int>> m_TSet;
+    rmt::FlatHashMap<rmt::PackedTriple, bool> m_RegSamples;
+
+    // Index of the count of each sample, or -1 if it is in no region, and of each couple
+    // and triple of samples contained in at least one region
+    std::vector<int> m_VIdx;
+    std::vector<int> m_VSamples;
+    rmt::FlatHashMap<std::uint64_t, int> m_EIdx;
+    rmt::FlatHashMap<rmt::PackedTriple, int> m_TIdx;
+
+    // Signed counts of the primal elements containing each sample, couple and triple,
+    // one set for each thread counting a part of the mesh
+    struct Counts
+    {
+        std::vector<int> V;
+        std::vector<int> E;
+        std::vector<int> T;
+    };
+    std::vector<Counts> m_Counts;
+
+    void CountSample(int pi, int Delta, Counts& C);
+    void CountCouple(int pi, int pj, int Delta, Counts& C);
 
 public:
     RegionDictionary();
@@ -100,6 +97,15 @@ public:
 
     void Clear();
     void Clear(size_t NumSamples);
+
+    /**
+     * @brief       Empties the dictionary, preparing it for NumRegions regions over NumSamples samples.
+     *
+     * @details     The cost depends on the regions held until now and not on the number of samples,
+     *              so the dictionary can be refilled cheaply with the few regions that changed.
+     */
+    void Clear(size_t NumSamples, size_t NumRegions);
+
     void AddRegion(int pi);
     void AddRegion(int pi, int pj);
     void AddRegion(int pi, int pj, int pk);
@@ -108,15 +114,47 @@ public:
     bool HasRegion(int pi, int pj) const;
     bool HasRegion(int pi, int pj, int pk) const;
 
-    void AddVertex(int pi);
+    /**
+     * @brief       Count a primal element with the counters of the given thread.
+     *
+     * @details     Threads with different indices can count elements concurrently.
+     */
+    void AddVertex(int pi, int ThreadID = 0);
     // void AddBoundaryVertex(int pi);
-    void AddEdge(int pi, int pj);
+    void AddEdge(int pi, int pj, int ThreadID = 0);
     // void AddBoundaryEdge(int pi, int pj);
-    void AddTriangle(int pi, int pj, int pk);
-
-    void BuildRegionMaps();
+    void AddTriangle(int pi, int pj, int pk, int ThreadID = 0);
+
+    /**
+     * @brief       Gives a count to the samples of the regions, and zeroes the counters of
+     *              NumThreads threads.
+     */
+    void BuildRegionMaps(int NumThreads = 1);
+
+    /**
+     * @brief       Sums the counters of all the threads into the ones of thread zero, which
+     *              are the ones giving the Euler characteristics.
+     *
+     * @details     The counts are integers, so the result does not depend on how the elements
+     *              were split among the threads.
+     */
+    void ReduceCounts();
     size_t NumRegions() const;
     const rmt::SurfaceRegion& GetRegion(size_t i) const;
+
+    /**
+     * @brief       The Euler characteristic of the i-th region.
+     *
+     * @details     Each primal vertex, edge and triangle adds its sign (+1, -1 and +1, as a dual face,
+     *              edge and vertex) to the count of its sample, or to the counts of its samples and of
+     *              their couples and triple if it crosses more cells. Then the characteristic of a
+     *              region follows by inclusion-exclusion, as the sum of the counts of its samples,
+     *              minus the counts of their couples, plus the count of their triple. Most elements
+     *              are inside a single cell, and update a single count.\n
+     *              The characteristic is computed from the counts of the dictionary, and not from the
+     *              rmt::SurfaceRegion, which only identifies the samples of the region.
+     */
+    int EulerCharacteristic(size_t i) const;
     bool IsClosed2Ball(size_t i) const;
 
 
@@ -32,13 +32,34 @@ void Remesh(const Eigen::MatrixXd& Vin,
             const Eigen::MatrixXi& Fin,
             int NSamples,
             Eigen::MatrixXd& Vout,
-            Eigen::MatrixXi& Fout);
+            Eigen::MatrixXi& Fout,
+            double Tolerance = 0.0);
 
 void Remesh(const Eigen::MatrixXd& Vin,
             const Eigen::MatrixXi& Fin,
             int NSamples,
             Eigen::MatrixXd& Vout,
             Eigen::MatrixXi& Fout,
-            Eigen::VectorXi& Vidx);
+            Eigen::VectorXi& Vidx,
+            double Tolerance = 0.0);
+
+/**
+ * @brief       Remeshes with as many samples as needed to bring the geodesic covering radius of the
+ *              sampling, before the refinement of the flat union, down to Radius.
+ */
+void RemeshToRadius(const Eigen::MatrixXd& Vin,
+                    const Eigen::MatrixXi& Fin,
+                    double Radius,
+                    Eigen::MatrixXd& Vout,
+                    Eigen::MatrixXi& Fout,
+                    double Tolerance = 0.0);
+
+void RemeshToRadius(const Eigen::MatrixXd& Vin,
+                    const Eigen::MatrixXi& Fin,
+                    double Radius,
+                    Eigen::MatrixXd& Vout,
+                    Eigen::MatrixXi& Fout,
+                    Eigen::VectorXi& Vidx,
+                    double Tolerance = 0.0);
 
 } // namespace rmt
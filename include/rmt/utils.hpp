@@ -13,6 +13,14 @@
 
 #include <utility>
 #include <functional>
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <filesystem>
 
 
 namespace rmt
@@ -39,6 +47,234 @@ struct TripleHash
 };
 
 
+/**
+ * @brief       Mixes the bits of a 64-bit integer with the finalizer of SplitMix64, so that
+ *              close integers have unrelated hashes.
+ */
+inline std::uint64_t MixBits(std::uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * @brief       Packs a couple of integers into a 64-bit key, the first one in the high bits.
+ */
+inline std::uint64_t PackPair(int a, int b)
+{
+    return ((std::uint64_t)(std::uint32_t)a << 32) | (std::uint32_t)b;
+}
+
+/**
+ * @brief       A triple of integers packed into a 64-bit key and a 32-bit one.
+ */
+struct PackedTriple
+{
+    std::uint64_t AB;
+    std::uint32_t C;
+};
+
+inline rmt::PackedTriple PackTriple(int a, int b, int c)
+{
+    return { rmt::PackPair(a, b), (std::uint32_t)c };
+}
+
+inline bool operator==(const rmt::PackedTriple& T1, const rmt::PackedTriple& T2)
+{
+    return T1.AB == T2.AB && T1.C == T2.C;
+}
+
+inline std::uint64_t HashKey(std::uint64_t Key) { return rmt::MixBits(Key); }
+inline std::uint64_t HashKey(const rmt::PackedTriple& Key) { return rmt::MixBits(Key.AB ^ rmt::MixBits(Key.C)); }
+
+
+/**
+ * @brief       Flat hash map with open addressing, for keys packed into integers.
+ *
+ * @details     The entries are stored contiguously in insertion order, and a power of two array
+ *              of slots, at most half full, holds their indices together with the high bits of
+ *              their hashes. Lookups probe the slots linearly, and only compare the keys of the
+ *              entries whose bits match. Iterating over the map visits the entries in insertion
+ *              order, so the results do not depend on the hash function.\n
+ *              Entries cannot be removed. Pointers to the values are invalidated by insertions.
+ */
+template<typename Key, typename Value>
+class FlatHashMap
+{
+private:
+    struct Slot
+    {
+        std::uint32_t Tag;
+        std::int32_t Index;
+    };
+
+    std::vector<std::pair<Key, Value>> m_Entries;
+    std::vector<Slot> m_Slots;
+
+    static std::size_t NumSlotsFor(std::size_t Size)
+    {
+        std::size_t NumSlots = 8;
+        while (NumSlots < 2 * Size)
+            NumSlots *= 2;
+        return NumSlots;
+    }
+
+    // The slot of the key, or the empty slot where it would be inserted
+    std::size_t Probe(const Key& K, std::uint64_t H) const
+    {
+        std::size_t Mask = m_Slots.size() - 1;
+        std::uint32_t Tag = H >> 32;
+        for (std::size_t s = H & Mask; ; s = (s + 1) & Mask)
+        {
+            const Slot& S = m_Slots[s];
+            if (S.Index == -1 || (S.Tag == Tag && m_Entries[S.Index].first == K))
+                return s;
+        }
+    }
+
+    void Rehash(std::size_t NumSlots)
+    {
+        m_Slots.assign(NumSlots, Slot{ 0, -1 });
+        for (std::size_t i = 0; i < m_Entries.size(); ++i)
+        {
+            std::uint64_t H = rmt::HashKey(m_Entries[i].first);
+            m_Slots[Probe(m_Entries[i].first, H)] = { (std::uint32_t)(H >> 32), (std::int32_t)i };
+        }
+    }
+
+public:
+    FlatHashMap() : m_Slots(NumSlotsFor(0), Slot{ 0, -1 }) { }
+
+    std::size_t Size() const { return m_Entries.size(); }
+    bool Empty() const { return m_Entries.empty(); }
+
+    void Reserve(std::size_t Size)
+    {
+        m_Entries.reserve(Size);
+        std::size_t NumSlots = NumSlotsFor(Size);
+        if (NumSlots > m_Slots.size())
+            Rehash(NumSlots);
+    }
+
+    /**
+     * @brief       Empties the map and prepares it for Size entries.
+     *
+     * @details     Emptying costs as much as the slots, so a map much larger than needed releases
+     *              them, and the cost does not depend on how many entries it held before.
+     */
+    void Clear(std::size_t Size = 0)
+    {
+        m_Entries.clear();
+        std::size_t NumSlots = NumSlotsFor(Size);
+        if (m_Slots.size() > 4 * NumSlots)
+        {
+            m_Entries.shrink_to_fit();
+            m_Slots.assign(NumSlots, Slot{ 0, -1 });
+            m_Slots.shrink_to_fit();
+        }
+        else
+            Rehash(std::max(NumSlots, m_Slots.size()));
+        m_Entries.reserve(Size);
+    }
+
+    Value* Find(const Key& K)
+    {
+        const Slot& S = m_Slots[Probe(K, rmt::HashKey(K))];
+        return S.Index == -1 ? nullptr : &m_Entries[S.Index].second;
+    }
+
+    const Value* Find(const Key& K) const
+    {
+        const Slot& S = m_Slots[Probe(K, rmt::HashKey(K))];
+        return S.Index == -1 ? nullptr : &m_Entries[S.Index].second;
+    }
+
+    bool Contains(const Key& K) const { return Find(K) != nullptr; }
+
+    /**
+     * @brief       Inserts the entry if the key is not in the map, with a single lookup.
+     *
+     * @return      The value of the key and whether it has been inserted.
+     */
+    std::pair<Value*, bool> Insert(const Key& K, const Value& V)
+    {
+        std::uint64_t H = rmt::HashKey(K);
+        std::size_t s = Probe(K, H);
+        if (m_Slots[s].Index != -1)
+            return { &m_Entries[m_Slots[s].Index].second, false };
+
+        if (2 * (m_Entries.size() + 1) > m_Slots.size())
+        {
+            Rehash(2 * m_Slots.size());
+            s = Probe(K, H);
+        }
+        m_Slots[s] = { (std::uint32_t)(H >> 32), (std::int32_t)m_Entries.size() };
+        m_Entries.emplace_back(K, V);
+        return { &m_Entries.back().second, true };
+    }
+
+    Value& operator[](const Key& K) { return *Insert(K, Value()).first; }
+
+    typename std::vector<std::pair<Key, Value>>::iterator begin() { return m_Entries.begin(); }
+    typename std::vector<std::pair<Key, Value>>::iterator end() { return m_Entries.end(); }
+    typename std::vector<std::pair<Key, Value>>::const_iterator begin() const { return m_Entries.begin(); }
+    typename std::vector<std::pair<Key, Value>>::const_iterator end() const { return m_Entries.end(); }
+};
+
+
+/**
+ * @brief       Alignment in bytes of the sections of the binary files, so that the arrays of a
+ *              memory mapped file can be used in place.
+ */
+constexpr int FileAlignment = 64;
+
+inline void WriteAlignmentPadding(std::ostream& Stream)
+{
+    static const char Zeros[FileAlignment] = { };
+    Stream.write(Zeros, (FileAlignment - Stream.tellp() % FileAlignment) % FileAlignment);
+}
+
+inline void SkipAlignmentPadding(std::istream& Stream)
+{
+    Stream.seekg((FileAlignment - Stream.tellg() % FileAlignment) % FileAlignment, std::ios::cur);
+}
+
+/**
+ * @brief       Writes a binary file with Write(Stream), through a temporary file renamed over it.
+ *
+ * @details     A crash while writing leaves the previous version of the file untouched, which
+ *              matters for checkpoints overwritten along a long computation.
+ */
+template<typename Writer>
+bool WriteFileSafely(const std::string& Filename, Writer&& Write)
+{
+    std::string TmpFilename = Filename + ".tmp";
+    bool Written;
+    {
+        std::ofstream Stream(TmpFilename, std::ios::binary);
+        if (!Stream.is_open())
+            return false;
+        Written = Write(Stream);
+        Stream.close();
+        Written = Written && !Stream.fail();
+    }
+
+    std::error_code Error;
+    if (Written)
+        std::filesystem::rename(TmpFilename, Filename, Error);
+    if (!Written || Error)
+    {
+        std::filesystem::remove(TmpFilename, Error);
+        return false;
+    }
+    return true;
+}
+
+
 
 
 } // namespace rmt
\ No newline at end of file
@@ -12,31 +12,106 @@
 #pragma once
 
 #include <rmt/graph.hpp>
+#include <rmt/queue.hpp>
+#include <rmt/parallel.hpp>
 #include <rmt/mesh.hpp>
 #include <cut/cut.hpp>
+#include <iostream>
+#include <string>
 
 
 namespace rmt
 {
-    
+
+/**
+ * @brief       Scalar type used to store the distances of a rmt::VoronoiPartitioning.
+ *
+ * @details     Distances are stored in double precision, unless the library is compiled with
+ *              RMT_COMPACT_VORONOI defined, in which case they are stored in single precision.
+ *              Sums along the paths are still computed in double precision, but each distance is
+ *              rounded when it is stored.
+ */
+#ifdef RMT_COMPACT_VORONOI
+typedef float SampleDistance;
+#else
+typedef double SampleDistance;
+#endif
+typedef Eigen::Matrix<rmt::SampleDistance, Eigen::Dynamic, 1> DistanceVector;
+
+
+/**
+ * @brief       Voronoi partitioning of a mesh, grown by farthest point sampling.
+ *
+ * @details     Besides the mesh itself, a partitioning of a closed mesh (about 6 directed edges per
+ *              vertex) takes about 116 bytes per vertex: 100 for the graph (24 for the positions,
+ *              4 for the offsets and 72 for the adjacency) and 16 for partitions, distances and
+ *              cells. The heap and the other structures of the cells are sized by the number of
+ *              samples, and add about 11 bytes per vertex after sampling a tenth of the mesh.\n
+ *              The compact mode, enabled by RMT_COMPACT_VORONOI together with RMT_FLOAT_EDGE_WEIGHTS
+ *              and RMT_FLOAT_VERTEX_POSITIONS, stores distances, edge weights and the positions of the
+ *              graph in single precision and takes about 76 bytes per vertex (64 for the graph).
+ *              Distances are then rounded along the way, so the seeded constructor is no longer
+ *              bitwise identical to inserting the seeds one at a time.
+ */
 class VoronoiPartitioning
 {
 private:
     rmt::Graph m_G;
     std::vector<int> m_Samples;
     Eigen::VectorXi m_Partitions;
-    Eigen::VectorXd m_Distances;
-    cut::MinHeap* m_HDists;
+    rmt::DistanceVector m_Distances;
+
+    // Vertices of each cell, possibly with stale entries of vertices moved to other cells
+    std::vector<std::vector<int>> m_CellVerts;
+    std::vector<int> m_CellSizes;
+    std::vector<int> m_CellFarthest;
+    rmt::IndexedMaxHeap m_HCells;
+
+    // Cells that gained or lost vertices since the last call to ClearChangedCells()
+    std::vector<int> m_ChangedCells;
+    std::vector<bool> m_CellChanged;
+
+    // Reused by AddSample(), so that inserting a sample does not allocate
+    rmt::RadixHeapQueue m_Frontier;
+    std::vector<std::pair<int, int>> m_Moved;
 
+    void GrowRegion(int NewSample, int Label, rmt::RadixHeapQueue& Frontier, std::vector<std::pair<int, int>>& Moved);
+    void BuildCells();
+    void UpdateCell(int Cell);
+    void CommitCell(int Label, const std::vector<std::pair<int, int>>& Moved);
+    void MarkChanged(int Cell);
+    int Sample(int Count, double Radius, double Tolerance, int NumThreads);
+    int Sample(int Count, double Radius, double Tolerance, rmt::ThreadPool& Pool);
+
+    VoronoiPartitioning(rmt::Graph&& G);
+    VoronoiPartitioning(rmt::Graph&& G, const std::vector<int>& Seeds, int NumThreads);
 
 public:
     VoronoiPartitioning(const rmt::Mesh& M);
+
+    /**
+     * @brief       Builds the partitioning induced by a given list of samples.
+     *
+     * @details     Partitions and distances are computed with a single multi-source sweep, and
+     *              are the same that adding the seeds one at a time would produce. Farthest point
+     *              sampling can continue from the seeds with AddSample() or AddSamples().\n
+     *              If a vertex is seeded twice, only its first occurrence gets a non-empty cell.
+     *              Vertices that cannot reach any seed are assigned to the first one with infinite
+     *              distance, as with the random first sample of the other constructor.
+     *
+     * @param M             The mesh.
+     * @param Seeds         The indices of the initial samples, which must be at least one.
+     * @param NumThreads    The number of threads of the sweep, zero to use all the hardware threads.
+     */
+    VoronoiPartitioning(const rmt::Mesh& M, const std::vector<int>& Seeds, int NumThreads = 0);
+    VoronoiPartitioning(const rmt::VoronoiPartitioning& VP);
+    rmt::VoronoiPartitioning& operator=(const rmt::VoronoiPartitioning& VP);
     VoronoiPartitioning(rmt::VoronoiPartitioning&& VP);
     rmt::VoronoiPartitioning& operator=(rmt::VoronoiPartitioning&& VP);
     ~VoronoiPartitioning();
 
     double GetDistance(int i) const;
-    const Eigen::VectorXd& GetDistances() const;
+    const rmt::DistanceVector& GetDistances() const;
     int GetPartition(int i) const;
     const Eigen::VectorXi& GetPartitions() const;
     
@@ -44,8 +119,137 @@ public:
     int GetSample(int i) const;
     const std::vector<int>& GetSamples() const;
 
+    /**
+     * @brief       The vertices of a cell.
+     *
+     * @details     The list can also contain vertices that have moved to other cells since, which
+     *              must be skipped by checking their partition.
+     */
+    const std::vector<int>& GetCellVertices(int Cell) const;
+
+    /**
+     * @brief       The cells that gained or lost vertices since the last call to ClearChangedCells().
+     *
+     * @details     The cell of a new sample is always changed, and so are all the cells when they are
+     *              built by a constructor or by Load(). The list has no duplicates, and allows updating
+     *              the data derived from the partitioning only where it changed.
+     */
+    const std::vector<int>& GetChangedCells() const;
+    void ClearChangedCells();
+
     int FarthestVertex() const;
+    double CoveringRadius() const;
     void AddSample(int NewSample);
+
+    /**
+     * @brief       Adds Count samples with farthest point sampling, inserting many samples at once.
+     *
+     * @details     Each round takes the current farthest distance R and collects the candidates whose
+     *              distance from the samples is at least (1 - Tolerance) * R. Starting from the farthest
+     *              vertex, the candidates are accepted greedily in order of decreasing distance if their
+     *              Euclidean distance from all the already accepted ones is at least 2 * (R + L), with L
+     *              the longest edge of the mesh.\n
+     *              The cells of the new samples are bounded by R, so the regions visited by their
+     *              insertions are disjoint and are grown concurrently. The result is the same as adding
+     *              the accepted samples one by one in acceptance order, and it does not depend on the
+     *              number of threads.\n
+     *              Every sample is at least (1 - Tolerance) times as far from the others as the farthest
+     *              vertex at the time of its insertion. A zero tolerance falls back to the exact
+     *              sequential sampling.
+     *
+     * @param Count         The number of samples to add.
+     * @param Tolerance     The relative tolerance on the farthest distance, in [0, 1).
+     * @param NumThreads    The number of threads, zero to use all the hardware threads. Small meshes
+     *                      are sampled on the calling thread.
+     *
+     * @return      The number of added samples, which is smaller than Count only if all the vertices are samples.
+     */
+    int AddSamples(int Count, double Tolerance, int NumThreads = 0);
+
+    /**
+     * @brief       Same as AddSamples(), with the threads of an existing pool.
+     *
+     * @details     Callers that sample in many steps, e.g. between two checkpoints, can keep the
+     *              same pool instead of spawning new threads at each call.
+     */
+    int AddSamples(int Count, double Tolerance, rmt::ThreadPool& Pool);
+
+    /**
+     * @brief       Adds samples with farthest point sampling until the covering radius is not larger than Radius.
+     *
+     * @details     The covering radius is the largest geodesic distance of a vertex from the samples,
+     *              as returned by CoveringRadius(). Samples are inserted as in AddSamples(), but the
+     *              sampling stops as soon as the radius is reached instead of at a given size. With a
+     *              positive tolerance, a batch never contains vertices already within Radius.
+     *
+     * @param Radius        The target covering radius.
+     * @param MaxCount      The maximum number of samples to add.
+     * @param Tolerance     The relative tolerance on the farthest distance, in [0, 1).
+     * @param NumThreads    The number of threads, zero to use all the hardware threads.
+     *
+     * @return      The number of added samples.
+     */
+    int AddSamplesToRadius(double Radius, int MaxCount, double Tolerance, int NumThreads = 0);
+    int AddSamplesToRadius(double Radius, int MaxCount, double Tolerance, rmt::ThreadPool& Pool);
+
+    /**
+     * @brief       Binary checkpoint of the sampling.
+     *
+     * @details     The file contains a header with the sizes, followed by the samples, the partitions
+     *              and the distances as raw arrays, each starting at a multiple of rmt::FileAlignment
+     *              bytes from the beginning of the file. The cells and their heap are rebuilt on load,
+     *              in a single linear pass, and the sampling continues exactly as if it had never been
+     *              interrupted.\n
+     *              The graph is not saved: a checkpoint can only be loaded by a partitioning of the
+     *              same mesh, and Load() fails if the number of vertices does not match, or if the
+     *              samples, partitions and distances are not consistent with each other.\n
+     *              Save() writes a temporary file next to the checkpoint and renames it over the old
+     *              one, so an interrupted save leaves the previous checkpoint valid.
+     */
+    bool Save(const std::string& Filename) const;
+    bool Load(const std::string& Filename);
+    bool Save(std::ostream& Stream) const;
+    bool Load(std::istream& Stream);
+
+    /**
+     * @brief       Farthest point sampling from coarse to fine.
+     *
+     * @details     The vertices are clustered on a uniform grid, splitting the clusters that are not
+     *              connected inside their voxel, and the clusters are connected if any of their vertices
+     *              are. The first CoarseFraction * NumSamples samples are taken with exact farthest point
+     *              sampling on this proxy graph, which has about 16 nodes for each coarse sample, and are
+     *              lifted to the mesh with one multi-source sweep. The remaining samples are added with
+     *              exact farthest point sampling on the mesh.\n
+     *              The early samples, whose cells cover most of the mesh, are the most expensive ones to
+     *              insert, and they are the ones that the proxy replaces. The coarse samples are not
+     *              exactly the farthest ones, but the last samples fix most of the difference.\n
+     *              If the proxy would not be much smaller than the mesh, this is the flat sampling.
+     *
+     * @param M                 The mesh.
+     * @param NumSamples        The number of samples.
+     * @param CoarseFraction    The fraction of samples taken on the proxy, in [0, 1].
+     * @param NumThreads        The number of threads, zero to use all the hardware threads.
+     */
+    static rmt::VoronoiPartitioning Hierarchical(const rmt::Mesh& M, int NumSamples,
+                                                 double CoarseFraction = 0.5, int NumThreads = 0);
+
+    /**
+     * @brief       Farthest point sampling with Euclidean distances.
+     *
+     * @details     The samples are picked by Euclidean farthest point sampling, backed by a kd-tree
+     *              over the vertices, and the geodesic partitioning is built once at the end with a
+     *              single multi-source sweep. The result is a regular geodesic partitioning of the
+     *              mesh, which can be further sampled and refined as usual.\n
+     *              This is faster than the geodesic sampling on dense meshes, and the samples
+     *              are about as good on nearly convex parts. Where the surface folds over itself, the
+     *              Euclidean distance underestimates the geodesic one and the sampling is too sparse.
+     *
+     * @param M             The mesh.
+     * @param NumSamples    The number of samples, which is smaller only if the remaining vertices
+     *                      coincide with the samples.
+     * @param NumThreads    The number of threads of the final sweep, zero to use all the hardware threads.
+     */
+    static rmt::VoronoiPartitioning Euclidean(const rmt::Mesh& M, int NumSamples, int NumThreads = 0);
 };
 
 
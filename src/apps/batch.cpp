@@ -21,6 +21,8 @@
 #include <nlohmann/json.hpp>
 
 #include <algorithm>
+#include <functional>
+#include <memory>
 #include <iostream>
 #include <fstream>
 #include <chrono>
@@ -45,7 +47,10 @@ struct rmtArgs
     std::vector<int> NumSamples;
     // double Resolution;
     std::vector<double> Resolution;
+    // Covering radii, as fractions of the bounding box diagonal
+    std::vector<double> Radius;
     bool FixedSize;
+    double Tolerance;
     bool Resampling;
     bool Evaluate;
 };
@@ -96,7 +101,9 @@ int main(int argc, const char* const argv[])
 
     int nMeshes = Args.InMeshes.size();
     int nReps = Args.Resolution.size();
-    if (Args.FixedSize)
+    if (!Args.Radius.empty())
+        nReps = Args.Radius.size();
+    else if (Args.FixedSize)
         nReps = Args.NumSamples.size();
     std::cout << "Remeshing " << nMeshes << " meshes from directory " << Args.InDir << std::endl;
     std::cout << "Output meshes will be saved to " << Args.OutDir << std::endl;
@@ -104,7 +111,18 @@ int main(int argc, const char* const argv[])
         std::cout << "Mehses will be resampled." << std::endl;
     else
         std::cout << "Meshes will not be resampled." << std::endl;
-    if (Args.FixedSize)
+    if (!Args.Radius.empty())
+    {
+        std::cout << "The samplings will have covering radii: ";
+        for (auto it = Args.Radius.begin(); it != Args.Radius.end(); it++)
+        {
+            std::cout << ((*it) * 100) << "%";
+            if (it != Args.Radius.end() - 1)
+                std::cout << ", ";
+        }
+        std::cout << " of the bounding box diagonal";
+    }
+    else if (Args.FixedSize)
     {
         std::cout << "The output meshes will have sizes: ";
         for (auto it = Args.NumSamples.begin(); it != Args.NumSamples.end(); it++)
@@ -150,39 +168,64 @@ int main(int argc, const char* const argv[])
                 Failures[i * nMeshes + j] = true;
             continue;
         }
+        // Without resampling, all the runs share the same repaired mesh. Sizes are sorted and
+        // FPS is prefix consistent, so each run extends the sampling of the previous one and
+        // works on a copy of it. Shared steps are only timed in the first run.
+        rmt::Mesh Mesh(Vp, Fp);
+        std::unique_ptr<rmt::VoronoiPartitioning> SharedVPart;
+        int nVertsOrig = Mesh.NumVertices();
         for (int j = 0; j < nReps; ++j)
         {
             int RunIdx = i * nReps + j;
-            rmt::Mesh Mesh(Vp, Fp);
-
-            int NSamples = Args.NumSamples[j];
-            if (!Args.FixedSize)
-                NSamples = Args.Resolution[j] * Mesh.NumVertices();
-            NSamples = std::min(NSamples, Mesh.NumVertices());
 
-            std::cout << "Remeshing " << Args.InMeshes[i] << " to " << NSamples << " vertices... " << std::endl;
+            int NSamples = nVertsOrig;
+            if (Args.Radius.empty() && Args.FixedSize)
+                NSamples = Args.NumSamples[j];
+            else if (Args.Radius.empty())
+                NSamples = Args.Resolution[j] * nVertsOrig;
+            NSamples = std::min(NSamples, nVertsOrig);
 
-            int nVertsOrig = Mesh.NumVertices();
-            StartTimer();
-            Mesh.MakeManifold();
-            Times[RunIdx].Repair = StopTimer();
+            if (!Args.Radius.empty())
+                std::cout << "Remeshing " << Args.InMeshes[i] << " to covering radius " << Args.Radius[j] * 100 << "%... " << std::endl;
+            else
+                std::cout << "Remeshing " << Args.InMeshes[i] << " to " << NSamples << " vertices... " << std::endl;
 
-            if (Args.Resampling)
+            if (Args.Resampling || j == 0)
             {
+                if (j > 0)
+                    Mesh = rmt::Mesh(Vp, Fp);
+
                 StartTimer();
-                Mesh.Resample(NSamples);
-                Times[RunIdx].Resampling = StopTimer();
-            }
+                Mesh.MakeManifold();
+                Times[RunIdx].Repair = StopTimer();
 
-            StartTimer();
-            Mesh.ComputeEdgesAndBoundaries();
-            Times[RunIdx].Boundary = StopTimer();
+                if (Args.Resampling)
+                {
+                    StartTimer();
+                    Mesh.Resample(NSamples);
+                    Times[RunIdx].Resampling = StopTimer();
+                }
+
+                StartTimer();
+                Mesh.ComputeEdgesAndBoundaries();
+                Times[RunIdx].Boundary = StopTimer();
+
+                StartTimer();
+                SharedVPart = std::make_unique<rmt::VoronoiPartitioning>(Mesh);
+                Times[RunIdx].VoronoiFPS = StopTimer();
+            }
 
             StartTimer();
-            rmt::VoronoiPartitioning VPart(Mesh);
-            while (VPart.NumSamples() < NSamples)
-                VPart.AddSample(VPart.FarthestVertex());
-            Times[RunIdx].VoronoiFPS = StopTimer();
+            if (!Args.Radius.empty())
+            {
+                // Radii are sorted in decreasing order, so each run still extends the previous one
+                double Diagonal = (Mesh.GetVertices().colwise().maxCoeff() - Mesh.GetVertices().colwise().minCoeff()).norm();
+                SharedVPart->AddSamplesToRadius(Args.Radius[j] * Diagonal, Mesh.NumVertices() - SharedVPart->NumSamples(), Args.Tolerance);
+            }
+            else
+                SharedVPart->AddSamples(NSamples - SharedVPart->NumSamples(), Args.Tolerance);
+            rmt::VoronoiPartitioning VPart(*SharedVPart);
+            Times[RunIdx].VoronoiFPS += StopTimer();
 
             StartTimer();
             rmt::FlatUnion FU(Mesh, VPart);
@@ -241,9 +284,11 @@ int main(int argc, const char* const argv[])
 
             if (Args.Evaluate)
             {
-                Mesh.RescaleInsideUnitBox();
+                // The mesh is shared with the next runs, so it is rescaled on a copy
+                Eigen::MatrixXd V = Mesh.GetVertices();
+                rmt::RescaleInsideUnitBox(V);
                 rmt::RescaleInsideUnitBox(VV);
-                Metrics[RunIdx] = rmt::Evaluate(Mesh.GetVertices(), Fp, VV, FF, nVertsOrig);
+                Metrics[RunIdx] = rmt::Evaluate(V, Fp, VV, FF, nVertsOrig);
             }
         }
     }
@@ -415,8 +460,10 @@ void SanityCheck(rmtArgs& Args)
         }
     }
 
-    // Sort num samples/resolution
-    if (Args.FixedSize)
+    // Sort num samples/resolution, and radii from the coarsest sampling
+    if (!Args.Radius.empty())
+        std::sort(Args.Radius.begin(), Args.Radius.end(), std::greater<double>());
+    else if (Args.FixedSize)
         std::sort(Args.NumSamples.begin(), Args.NumSamples.end());
     else
         std::sort(Args.Resolution.begin(), Args.Resolution.end());
@@ -475,6 +522,7 @@ rmtArgs ParseFromFile(const std::string& Filename)
     // Args.NumSamples = 0;
     // Args.Resolution = 0.0;
     Args.FixedSize = true;
+    Args.Tolerance = 0.0;
     Args.Resampling = false;
     Args.Evaluate = false;
 
@@ -539,6 +587,47 @@ rmtArgs ParseFromFile(const std::string& Filename)
         }
         Args.Evaluate = j["evaluate"];
     }
+    if (j.contains("fps_tolerance"))
+    {
+        if (!j["fps_tolerance"].is_number() || j["fps_tolerance"] < 0.0 || j["fps_tolerance"] >= 1.0)
+        {
+            std::cerr << Filename << " contains attribute \"fps_tolerance\", but it is not a number in [0, 1)." << std::endl;
+            exit(-1);
+        }
+        Args.Tolerance = j["fps_tolerance"];
+    }
+
+    if (j.contains("relative_radius"))
+    {
+        if (j.contains("num_samples") || j.contains("resolution"))
+        {
+            std::cerr << Filename << " contains attribute \"relative_radius\", which cannot be combined with \"num_samples\" or \"resolution\"." << std::endl;
+            exit(-1);
+        }
+        if (Args.Resampling)
+        {
+            std::cerr << Filename << " contains attribute \"relative_radius\", but resampling requires \"num_samples\" or \"resolution\"." << std::endl;
+            exit(-1);
+        }
+        if (!j["relative_radius"].is_number() && !j["relative_radius"].is_array())
+        {
+            std::cerr << Filename << " contains attribute \"relative_radius\", but it is not a number neither an array." << std::endl;
+            exit(-1);
+        }
+        if (j["relative_radius"].is_number())
+            Args.Radius.emplace_back(j["relative_radius"]);
+        else
+            Args.Radius = j["relative_radius"].template get<std::vector<double>>();
+        for (double r : Args.Radius)
+        {
+            if (r <= 0.0 || r > 1.0)
+            {
+                std::cerr << Filename << " contains a \"relative_radius\" attribute with value (" << r << "), which is outside the interval (0, 1]." << std::endl;
+                exit(-1);
+            }
+        }
+        return Args;
+    }
 
     if (j.contains("fixed_size"))
     {
@@ -660,14 +749,25 @@ void Usage(const std::string& Prog, bool IsError)
 std::string OutputName(const rmtArgs& Args, int Run, const std::string& Name)
 {
     // If only a single run must be performed, output the identity
-    if (Args.FixedSize && Args.NumSamples.size() == 1)
+    if (!Args.Radius.empty() && Args.Radius.size() == 1)
+        return Name;
+    else if (Args.Radius.empty() && Args.FixedSize && Args.NumSamples.size() == 1)
         return Name;
-    else if (!Args.FixedSize && Args.Resolution.size() == 1)
+    else if (Args.Radius.empty() && !Args.FixedSize && Args.Resolution.size() == 1)
         return Name;
 
     // Otherwise, get a proper directory name
     std::stringstream ss;
-    if (Args.FixedSize)
+    if (!Args.Radius.empty())
+    {
+        int MaxPrecision = -1;
+        for (int i = 0; i < Args.Radius.size(); ++i)
+            MaxPrecision = std::min(MaxPrecision, (int)std::ceil(std::log10(Args.Radius[i])));
+        MaxPrecision = -(MaxPrecision - 1);
+        ss.precision(MaxPrecision);
+        ss << "rad-" << Args.Radius[Run];
+    }
+    else if (Args.FixedSize)
     {
         int MaxPrecision = 1;
         for (int i = 0; i < Args.NumSamples.size(); ++i)
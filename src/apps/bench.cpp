@@ -0,0 +1,425 @@
+/**
+ * @file        bench.cpp
+ *
+ * @brief       Application for benchmarking the building blocks of the remeshing.
+ *
+ * @author      agent (agent@local)
+ *
+ * @date        2026-10-16
+ */
+#define NOMINMAX
+#include <rmt/rmt.hpp>
+#include <rmt/contraction.hpp>
+
+#include <Eigen/Dense>
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+
+
+
+void StartTimer();
+double StopTimer();
+
+struct rmtArgs
+{
+    std::string Mode;
+    std::string InMesh;
+    int NumRuns;
+};
+
+rmtArgs ParseArgs(int argc, const char* const argv[]);
+void Usage(const std::string& Prog, bool IsError = false);
+
+void BenchDijkstra(const rmt::Mesh& Mesh, const rmtArgs& Args);
+void BenchContraction(const rmt::Mesh& Mesh, const rmtArgs& Args);
+void BenchSampling(const rmt::Mesh& Mesh, const rmtArgs& Args);
+void BenchHierarchical(const rmt::Mesh& Mesh, const rmtArgs& Args);
+void BenchTopology(const rmt::Mesh& Mesh, const rmtArgs& Args);
+void BenchTopologyScaling(const rmt::Mesh& Mesh, const rmtArgs& Args);
+
+
+
+int main(int argc, const char* const argv[])
+{
+    auto Args = ParseArgs(argc, argv);
+
+    std::cout << "Loading mesh " << Args.InMesh << "... ";
+    StartTimer();
+    rmt::Mesh Mesh(Args.InMesh);
+    double t = StopTimer();
+    std::cout << "Elapsed time is " << t << " s." << std::endl;
+    std::cout << "Number of vertices:  " << Mesh.NumVertices() << std::endl;
+    std::cout << "Number of triangles: " << Mesh.NumTriangles() << std::endl;
+
+    // The flat union reads the edges of the mesh
+    std::cout << "Computing mesh edges and boundaries... ";
+    StartTimer();
+    Mesh.ComputeEdgesAndBoundaries();
+    t = StopTimer();
+    std::cout << "Elapsed time is " << t << " s." << std::endl;
+
+    if (Args.Mode == "dijkstra")
+        BenchDijkstra(Mesh, Args);
+    else if (Args.Mode == "ch")
+        BenchContraction(Mesh, Args);
+    else if (Args.Mode == "fps")
+        BenchSampling(Mesh, Args);
+    else if (Args.Mode == "hfps")
+        BenchHierarchical(Mesh, Args);
+    else if (Args.Mode == "topo")
+        BenchTopology(Mesh, Args);
+    else if (Args.Mode == "scaling")
+        BenchTopologyScaling(Mesh, Args);
+    else
+    {
+        std::cerr << "Unknown benchmark " << Args.Mode << '.' << std::endl;
+        Usage(argv[0], true);
+    }
+
+    return 0;
+}
+
+
+
+
+
+void BenchDijkstra(const rmt::Mesh& Mesh, const rmtArgs& Args)
+{
+    rmt::Graph G(Mesh.GetVertices(), Mesh.GetTriangles());
+
+    std::mt19937 Eng(0);
+    std::uniform_int_distribution<int> Distr(0, G.NumVertices() - 1);
+    std::vector<int> Sources;
+    for (int i = 0; i < Args.NumRuns; ++i)
+        Sources.emplace_back(Distr(Eng));
+
+    const std::vector<std::pair<std::string, rmt::QueueEngine>> Engines = {
+        { "binary heap", rmt::QueueEngine::BinaryHeap },
+        { "radix heap",  rmt::QueueEngine::RadixHeap }
+    };
+
+    std::vector<double> Times;
+    Eigen::VectorXd D;
+    for (const auto& Engine : Engines)
+    {
+        G.SetQueueEngine(Engine.second);
+        StartTimer();
+        for (int src : Sources)
+            G.DijkstraDistance(src, D);
+        Times.emplace_back(StopTimer() / Args.NumRuns);
+        std::cout << "Full Dijkstra with " << Engine.first << ": " << Times.back() << " s per query." << std::endl;
+    }
+    for (size_t i = 1; i < Times.size(); ++i)
+        std::cout << "Speedup of " << Engines[i].first << ": " << Times[0] / Times[i] << "x" << std::endl;
+}
+
+
+void BenchContraction(const rmt::Mesh& Mesh, const rmtArgs& Args)
+{
+    rmt::Graph G(Mesh.GetVertices(), Mesh.GetTriangles());
+
+    std::cout << "Building contraction hierarchy... ";
+    StartTimer();
+    rmt::ContractionHierarchy CH(G);
+    std::cout << "Elapsed time is " << StopTimer() << " s." << std::endl;
+    std::cout << "Number of upward edges: " << CH.NumEdges() << " (" << 2 * G.NumEdges() << " directed edges in the graph)" << std::endl;
+
+    std::mt19937 Eng(0);
+    std::uniform_int_distribution<int> Distr(0, G.NumVertices() - 1);
+    std::vector<std::pair<int, int>> Queries;
+    for (int i = 0; i < Args.NumRuns; ++i)
+        Queries.emplace_back(Distr(Eng), Distr(Eng));
+
+    rmt::DijkstraWorkspace Fwd;
+    rmt::DijkstraWorkspace Bwd;
+    std::vector<double> Expected;
+    StartTimer();
+    for (const auto& q : Queries)
+        Expected.emplace_back(G.DijkstraPath(q.first, q.second, Fwd).first);
+    double TDijkstra = StopTimer() / Args.NumRuns;
+
+    std::vector<double> Distances;
+    StartTimer();
+    for (const auto& q : Queries)
+        Distances.emplace_back(CH.Distance(q.first, q.second, Fwd, Bwd));
+    double TCH = StopTimer() / Args.NumRuns;
+
+    double MaxError = 0.0;
+    for (int i = 0; i < Args.NumRuns; ++i)
+        MaxError = std::max(MaxError, std::abs(Distances[i] - Expected[i]) / std::max(Expected[i], 1.0e-12));
+
+    std::cout << "Dijkstra path query: " << TDijkstra * 1.0e6 << " us per query." << std::endl;
+    std::cout << "Contraction hierarchy query: " << TCH * 1.0e6 << " us per query." << std::endl;
+    std::cout << "Speedup: " << TDijkstra / TCH << "x" << std::endl;
+    std::cout << "Maximum relative difference: " << MaxError << std::endl;
+}
+
+
+void BenchSampling(const rmt::Mesh& Mesh, const rmtArgs& Args)
+{
+    // Same density as a remeshing to 10% of the input vertices
+    int NSamples = std::max(Mesh.NumVertices() / 10, 2);
+
+    double TInit = 0.0;
+    double TSampling = 0.0;
+    for (int i = 0; i < Args.NumRuns; ++i)
+    {
+        StartTimer();
+        rmt::VoronoiPartitioning VPart(Mesh);
+        TInit += StopTimer();
+
+        StartTimer();
+        while (VPart.NumSamples() < NSamples)
+            VPart.AddSample(VPart.FarthestVertex());
+        TSampling += StopTimer();
+    }
+    TInit /= Args.NumRuns;
+    TSampling /= Args.NumRuns;
+
+    std::cout << "Voronoi partitioning initialization: " << TInit << " s." << std::endl;
+    std::cout << "Farthest point sampling of " << NSamples << " samples: " << TSampling << " s." << std::endl;
+    std::cout << "AddSample throughput: " << (NSamples - 1) / TSampling << " samples/s." << std::endl;
+}
+
+
+void BenchHierarchical(const rmt::Mesh& Mesh, const rmtArgs& Args)
+{
+    // At 10% of the vertices the proxy would be as large as the mesh
+    int NSamples = std::max(Mesh.NumVertices() / 100, 2);
+
+    double TFlat = 0.0;
+    double RFlat = 0.0;
+    for (int i = 0; i < Args.NumRuns; ++i)
+    {
+        StartTimer();
+        rmt::VoronoiPartitioning VPart(Mesh);
+        VPart.AddSamples(NSamples - 1, 0.0);
+        TFlat += StopTimer();
+        RFlat = VPart.GetDistances().maxCoeff();
+    }
+    TFlat /= Args.NumRuns;
+    std::cout << "Flat sampling of " << NSamples << " samples: " << TFlat << " s, radius " << RFlat << '.' << std::endl;
+
+    for (double CoarseFraction : { 0.25, 0.5, 0.75, 0.9 })
+    {
+        double THier = 0.0;
+        double RHier = 0.0;
+        for (int i = 0; i < Args.NumRuns; ++i)
+        {
+            StartTimer();
+            auto VPart = rmt::VoronoiPartitioning::Hierarchical(Mesh, NSamples, CoarseFraction);
+            THier += StopTimer();
+            RHier = VPart.GetDistances().maxCoeff();
+        }
+        THier /= Args.NumRuns;
+        std::cout << "Hierarchical sampling with " << CoarseFraction * 100 << "% coarse samples: " << THier << " s, radius " << RHier;
+        std::cout << " (speedup " << TFlat / THier << "x, radius ratio " << RHier / RFlat << ")." << std::endl;
+    }
+
+    double TEucl = 0.0;
+    double REucl = 0.0;
+    for (int i = 0; i < Args.NumRuns; ++i)
+    {
+        StartTimer();
+        auto VPart = rmt::VoronoiPartitioning::Euclidean(Mesh, NSamples);
+        TEucl += StopTimer();
+        REucl = VPart.GetDistances().maxCoeff();
+    }
+    TEucl /= Args.NumRuns;
+    std::cout << "Euclidean sampling: " << TEucl << " s, radius " << REucl;
+    std::cout << " (speedup " << TFlat / TEucl << "x, radius ratio " << REucl / RFlat << ")." << std::endl;
+}
+
+
+void BenchTopology(const rmt::Mesh& Mesh, const rmtArgs& Args)
+{
+    // Same density as a remeshing to 10% of the input vertices
+    int NSamples = std::max(Mesh.NumVertices() / 10, 2);
+    rmt::VoronoiPartitioning VPart(Mesh);
+    VPart.AddSamples(NSamples - 1, 0.0);
+
+    double TRegions = 0.0;
+    double TTopologies = 0.0;
+    double TLoop = 0.0;
+    int NIterations = 0;
+    for (int i = 0; i < Args.NumRuns; ++i)
+    {
+        rmt::VoronoiPartitioning VPartRun(VPart);
+        rmt::FlatUnion FU(Mesh, VPartRun);
+
+        StartTimer();
+        FU.DetermineRegions();
+        TRegions += StopTimer();
+
+        StartTimer();
+        FU.ComputeTopologies();
+        TTopologies += StopTimer();
+
+        StartTimer();
+        while (!FU.FixIssues())
+        {
+            FU.DetermineRegions();
+            FU.ComputeTopologies();
+        }
+        TLoop += StopTimer();
+        NIterations = FU.NumIterations();
+    }
+    TRegions /= Args.NumRuns;
+    TTopologies /= Args.NumRuns;
+    TLoop /= Args.NumRuns;
+
+    std::cout << "FlatUnion::DetermineRegions() with " << NSamples << " samples: " << TRegions << " s." << std::endl;
+    std::cout << "FlatUnion::ComputeTopologies() with " << NSamples << " samples: " << TTopologies << " s." << std::endl;
+    std::cout << "Rest of the refinement loop, " << NIterations << " iterations: " << TLoop << " s." << std::endl;
+}
+
+
+void BenchTopologyScaling(const rmt::Mesh& Mesh, const rmtArgs& Args)
+{
+    // Same density as a remeshing to 10% of the input vertices
+    int NSamples = std::max(Mesh.NumVertices() / 10, 2);
+    rmt::VoronoiPartitioning VPart(Mesh);
+    VPart.AddSamples(NSamples - 1, 0.0);
+
+    // Powers of two up to the hardware threads, and the hardware threads
+    std::vector<int> NumThreads;
+    int MaxThreads = rmt::DefaultNumThreads();
+    for (int t = 1; t < MaxThreads; t *= 2)
+        NumThreads.emplace_back(t);
+    NumThreads.emplace_back(MaxThreads);
+    if (MaxThreads == 1)
+        std::cout << "Only one hardware thread is available, so the speedup cannot be measured." << std::endl;
+
+    double TSerial = 0.0;
+    for (int NThreads : NumThreads)
+    {
+        double TRegions = 0.0;
+        double TTopologies = 0.0;
+        int NOpen = 0;
+        for (int i = 0; i < Args.NumRuns; ++i)
+        {
+            rmt::VoronoiPartitioning VPartRun(VPart);
+            rmt::FlatUnion FU(Mesh, VPartRun, NThreads);
+
+            StartTimer();
+            FU.DetermineRegions();
+            TRegions += StopTimer();
+
+            StartTimer();
+            FU.ComputeTopologies();
+            TTopologies += StopTimer();
+
+            // The samples to insert do not depend on the threads
+            FU.FixIssues();
+            NOpen = VPartRun.NumSamples() - NSamples;
+        }
+        TRegions /= Args.NumRuns;
+        TTopologies /= Args.NumRuns;
+        double TTotal = TRegions + TTopologies;
+        if (NThreads == 1)
+            TSerial = TTotal;
+
+        std::cout << NThreads << " threads: DetermineRegions() " << TRegions << " s, ComputeTopologies() " << TTopologies << " s";
+        std::cout << " (speedup " << TSerial / TTotal << "x, efficiency " << 100.0 * TSerial / TTotal / NThreads << "%, ";
+        std::cout << NOpen << " samples to insert)." << std::endl;
+    }
+}
+
+
+
+
+
+std::chrono::steady_clock::time_point Start;
+void StartTimer()
+{
+    Start = std::chrono::steady_clock::now();
+}
+
+double StopTimer()
+{
+    std::chrono::steady_clock::time_point End;
+    End = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(End - Start).count();
+}
+
+rmtArgs ParseArgs(int argc, const char* const argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argvi(argv[i]);
+        if (argvi == "-h" || argvi == "--help")
+        {
+            Usage(argv[0]);
+            exit(0);
+        }
+    }
+
+    rmtArgs Args;
+    Args.Mode = "";
+    Args.InMesh = "";
+    Args.NumRuns = 10;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argvi(argv[i]);
+        if (argvi == "-n" || argvi == "--runs")
+        {
+            if (i == argc - 1)
+                Usage(argv[0], true);
+            Args.NumRuns = std::stoi(argv[++i]);
+            continue;
+        }
+        if (Args.Mode.empty())
+            Args.Mode = argvi;
+        else
+            Args.InMesh = argvi;
+    }
+
+    if (Args.Mode.empty() || Args.InMesh.empty())
+    {
+        std::cerr << "No benchmark or input mesh given." << std::endl;
+        Usage(argv[0], true);
+    }
+    if (Args.NumRuns <= 0)
+    {
+        std::cerr << "The number of runs must be positive." << std::endl;
+        Usage(argv[0], true);
+    }
+
+    return Args;
+}
+
+
+void Usage(const std::string& Prog, bool IsError)
+{
+    std::ostream* _out = &std::cout;
+    if (IsError)
+        _out = &std::cerr;
+    std::ostream& out = *_out;
+
+    out << std::endl;
+    out << Prog << " usage:" << std::endl;
+    out << std::endl;
+    out << "\t" << Prog << " benchmark input_mesh [-n|--runs num_runs]" << std::endl;
+    out << "\t" << Prog << " -h|--help" << std::endl;
+    out << std::endl;
+    out << "Arguments details:" << std::endl;
+    out << "\t- benchmark is the name of the benchmark to run. Available benchmarks are:" << std::endl;
+    out << "\t    - dijkstra, which compares the queue engines of rmt::Graph;" << std::endl;
+    out << "\t    - ch, which compares rmt::ContractionHierarchy with Graph::DijkstraPath();" << std::endl;
+    out << "\t    - fps, which measures the throughput of VoronoiPartitioning::AddSample();" << std::endl;
+    out << "\t    - hfps, which compares hierarchical and Euclidean farthest point sampling with the flat one;" << std::endl;
+    out << "\t    - topo, which measures the steps of the flat union refinement loop;" << std::endl;
+    out << "\t    - scaling, which measures the strong scaling of the first step of the flat union refinement loop;" << std::endl;
+    out << "\t- input_mesh is the file containing the mesh to process;" << std::endl;
+    out << "\t- -n|--runs sets the number of repetitions of each measure (default 10);" << std::endl;
+    out << "\t- -h|--help prints this message." << std::endl;
+
+    if (IsError)
+        exit(-1);
+}
@@ -42,7 +42,14 @@ struct rmtArgs
 {
     std::string InMesh;
     std::string OutMesh;
+    std::string Seeds;
+    std::string Checkpoint;
+    int CheckpointInterval;
     int NumSamples;
+    double Tolerance;
+    double Radius;
+    double RelativeRadius;
+    bool Euclidean;
     bool Resampling;
     bool Evaluate;
 };
@@ -50,6 +57,7 @@ struct rmtArgs
 std::pair<int, int> NonManifoldGeometry(const Eigen::MatrixXi& F);
 
 rmtArgs ParseArgs(int argc, const char* const argv[]);
+void CheckSizing(const rmtArgs& Args);
 void Usage(const std::string& Prog, bool IsError = false);
 
 int main(int argc, const char* const argv[])
@@ -100,23 +108,92 @@ int main(int argc, const char* const argv[])
     TotTime += t;
     std::cout << "Elapsed time is " << t << " s." << std::endl;
 
-    std::cout << "Computing Voronoi FPS with " << Args.NumSamples << " samples... ";
+    std::vector<int> Seeds;
+    if (!Args.Seeds.empty() && Args.Euclidean)
+    {
+        std::cerr << "Euclidean sampling cannot start from seeds." << std::endl;
+        return -1;
+    }
+    if (!Args.Seeds.empty())
+    {
+        Eigen::VectorXi Idx;
+        if (!Eigen::loadMarketDense(Idx, Args.Seeds))
+        {
+            std::cerr << "Cannot read the seeds from " << Args.Seeds << '.' << std::endl;
+            return -1;
+        }
+        Seeds.assign(Idx.data(), Idx.data() + Idx.rows());
+        if (Seeds.empty() || Idx.minCoeff() < 0 || Idx.maxCoeff() >= Mesh.NumVertices())
+        {
+            std::cerr << "The seeds in " << Args.Seeds << " are not valid vertex indices of the mesh." << std::endl;
+            return -1;
+        }
+        std::cout << "Starting from " << Seeds.size() << " seeds read from " << Args.Seeds << '.' << std::endl;
+    }
+
+    // A relative radius is a fraction of the bounding box diagonal
+    double Radius = Args.Radius;
+    if (Args.RelativeRadius > 0.0)
+        Radius = Args.RelativeRadius * (Mesh.GetVertices().colwise().maxCoeff() - Mesh.GetVertices().colwise().minCoeff()).norm();
+
+    if (Radius > 0.0)
+        std::cout << "Computing Voronoi FPS up to radius " << Radius << "... ";
+    else
+        std::cout << "Computing Voronoi FPS with " << Args.NumSamples << " samples... ";
     StartTimer();
-    rmt::VoronoiPartitioning VPart(Mesh);
-    while (VPart.NumSamples() < Args.NumSamples)
-        VPart.AddSample(VPart.FarthestVertex());
+    // An existing checkpoint replaces the initial sampling
+    bool Resume = !Args.Checkpoint.empty() && std::filesystem::exists(Args.Checkpoint);
+    rmt::VoronoiPartitioning VPart = Resume ? rmt::VoronoiPartitioning(Mesh) :
+                                     Args.Euclidean ? rmt::VoronoiPartitioning::Euclidean(Mesh, Args.NumSamples) :
+                                     Seeds.empty() ? rmt::VoronoiPartitioning(Mesh) : rmt::VoronoiPartitioning(Mesh, Seeds);
+    rmt::FlatUnion FU(Mesh, VPart);
+    if (Resume && !FU.Load(Args.Checkpoint))
+    {
+        std::cerr << "Cannot resume from checkpoint " << Args.Checkpoint << '.' << std::endl;
+        return -1;
+    }
+    auto Checkpoint = [&]()
+    {
+        if (!Args.Checkpoint.empty() && !FU.Save(Args.Checkpoint))
+            std::cerr << "Cannot write checkpoint " << Args.Checkpoint << '.' << std::endl;
+    };
+
+    // Without checkpoints, all the samples are added at once. A batch of the parallel sampling
+    // stops at each checkpoint, so the interval is part of the options that define the result
+    int Interval = Args.Checkpoint.empty() ? Mesh.NumVertices() : Args.CheckpointInterval;
+    rmt::ThreadPool Pool(Args.Tolerance > 0.0 ? rmt::NumThreadsFor(0, Mesh.NumVertices()) : 1);
+    int Added;
+    do
+    {
+        if (Radius > 0.0)
+        {
+            // When given, num_samples bounds the size of the sampling
+            int MaxSamples = Args.NumSamples == -1 ? Mesh.NumVertices() : Args.NumSamples;
+            Added = VPart.AddSamplesToRadius(Radius, std::min(Interval, MaxSamples - VPart.NumSamples()), Args.Tolerance, Pool);
+        }
+        else
+            Added = VPart.AddSamples(std::min(Interval, Args.NumSamples - VPart.NumSamples()), Args.Tolerance, Pool);
+        if (Added > 0)
+            Checkpoint();
+    } while (Added == Interval);
     t = StopTimer();
     TotTime += t;
     std::cout << "Elapsed time is " << t << " s." << std::endl;
+    if (Resume)
+        std::cout << "Resumed from checkpoint " << Args.Checkpoint << " after " << FU.NumIterations() << " refinement iterations." << std::endl;
+    if (Radius > 0.0)
+        std::cout << "Sampled " << VPart.NumSamples() << " vertices with covering radius " << VPart.CoveringRadius() << '.' << std::endl;
 
     std::cout << "Refining sampling to ensure closed ball property... ";
     StartTimer();
-    rmt::FlatUnion FU(Mesh, VPart);
+    bool Done;
     do
     {
         FU.DetermineRegions();
         FU.ComputeTopologies();
-    } while (!FU.FixIssues());
+        Done = FU.FixIssues();
+        Checkpoint();
+    } while (!Done);
     t = StopTimer();
     TotTime += t;
     std::cout << "Elapsed time is " << t << " s." << std::endl;
@@ -247,6 +324,26 @@ double StopTimer()
     return ms * 1.0e-3;
 }
 
+void CheckSizing(const rmtArgs& Args)
+{
+    bool HasRadius = Args.Radius > 0.0 || Args.RelativeRadius > 0.0;
+    if (Args.Radius > 0.0 && Args.RelativeRadius > 0.0)
+    {
+        std::cerr << "The sampling radius can be either absolute or relative, not both." << std::endl;
+        exit(-1);
+    }
+    if (HasRadius && Args.Euclidean)
+    {
+        std::cerr << "Euclidean sampling does not support a target radius." << std::endl;
+        exit(-1);
+    }
+    if (Args.NumSamples == -1 && Args.Resampling)
+    {
+        std::cerr << "Resampling requires the number of samples." << std::endl;
+        exit(-1);
+    }
+}
+
 rmtArgs ParseFromFile(const std::string& Filename)
 {
     std::ifstream Stream;
@@ -276,9 +373,9 @@ rmtArgs ParseFromFile(const std::string& Filename)
         std::cerr << "Configuration file must contain the \'input_mesh\' attribute." << std::endl;
         exit(-1);
     }
-    if (!j.contains("num_samples"))
+    if (!j.contains("num_samples") && !j.contains("fps_radius") && !j.contains("fps_relative_radius"))
     {
-        std::cerr << "Configuration file must contain the \'num_samples\' attribute." << std::endl;
+        std::cerr << "Configuration file must contain the \'num_samples\' attribute, or one of \'fps_radius\' and \'fps_relative_radius\'." << std::endl;
         exit(-1);
     }
 
@@ -287,7 +384,7 @@ rmtArgs ParseFromFile(const std::string& Filename)
         std::cerr << "\'input_mesh\' attribute must be a string." << std::endl;
         exit(-1);
     }
-    if (!j["num_samples"].is_number_integer())
+    if (j.contains("num_samples") && !j["num_samples"].is_number_integer())
     {
         std::cerr << "\'num_samples\' attribute must be an integer numeric value." << std::endl;
         exit(-1);
@@ -295,7 +392,14 @@ rmtArgs ParseFromFile(const std::string& Filename)
 
     rmtArgs Args;
     Args.InMesh = j["input_mesh"];
-    Args.NumSamples = j["num_samples"];
+    Args.NumSamples = j.contains("num_samples") ? (int)j["num_samples"] : -1;
+    Args.Seeds = "";
+    Args.Checkpoint = "";
+    Args.CheckpointInterval = 10000;
+    Args.Tolerance = 0.0;
+    Args.Radius = -1.0;
+    Args.RelativeRadius = -1.0;
+    Args.Euclidean = false;
     Args.Resampling = false;
     Args.Evaluate = false;
     Args.OutMesh = std::filesystem::path(Args.InMesh).filename().string();
@@ -321,6 +425,76 @@ rmtArgs ParseFromFile(const std::string& Filename)
         Args.Evaluate = j["evaluate"];
     }
 
+    if (j.contains("seeds"))
+    {
+        if (!j["seeds"].is_string())
+        {
+            std::cerr << "When provided, \'seeds\' attribute must be a string." << std::endl;
+            exit(-1);
+        }
+        Args.Seeds = j["seeds"];
+    }
+
+    if (j.contains("checkpoint"))
+    {
+        if (!j["checkpoint"].is_string())
+        {
+            std::cerr << "When provided, \'checkpoint\' attribute must be a string." << std::endl;
+            exit(-1);
+        }
+        Args.Checkpoint = j["checkpoint"];
+    }
+
+    if (j.contains("checkpoint_interval"))
+    {
+        if (!j["checkpoint_interval"].is_number_integer() || j["checkpoint_interval"] <= 0)
+        {
+            std::cerr << "When provided, \'checkpoint_interval\' attribute must be a positive integer numeric value." << std::endl;
+            exit(-1);
+        }
+        Args.CheckpointInterval = j["checkpoint_interval"];
+    }
+
+    if (j.contains("fps_tolerance"))
+    {
+        if (!j["fps_tolerance"].is_number() || j["fps_tolerance"] < 0.0 || j["fps_tolerance"] >= 1.0)
+        {
+            std::cerr << "When provided, \'fps_tolerance\' attribute must be a numeric value in [0, 1)." << std::endl;
+            exit(-1);
+        }
+        Args.Tolerance = j["fps_tolerance"];
+    }
+
+    if (j.contains("fps_radius"))
+    {
+        if (!j["fps_radius"].is_number() || j["fps_radius"] <= 0.0)
+        {
+            std::cerr << "When provided, \'fps_radius\' attribute must be a positive numeric value." << std::endl;
+            exit(-1);
+        }
+        Args.Radius = j["fps_radius"];
+    }
+
+    if (j.contains("fps_relative_radius"))
+    {
+        if (!j["fps_relative_radius"].is_number() || j["fps_relative_radius"] <= 0.0 || j["fps_relative_radius"] > 1.0)
+        {
+            std::cerr << "When provided, \'fps_relative_radius\' attribute must be a numeric value in (0, 1]." << std::endl;
+            exit(-1);
+        }
+        Args.RelativeRadius = j["fps_relative_radius"];
+    }
+
+    if (j.contains("euclidean_fps"))
+    {
+        if (!j["euclidean_fps"].is_boolean())
+        {
+            std::cerr << "When provided, \'euclidean_fps\' attribute must be boolean." << std::endl;
+            exit(-1);
+        }
+        Args.Euclidean = j["euclidean_fps"];
+    }
+
     if (j.contains("out_mesh"))
     {
         if (!j["out_mesh"].is_string())
@@ -331,6 +505,7 @@ rmtArgs ParseFromFile(const std::string& Filename)
         Args.OutMesh = j["out_mesh"];
     }
 
+    CheckSizing(Args);
     return Args;
 }
 
@@ -351,6 +526,13 @@ rmtArgs ParseArgs(int argc, const char* const argv[])
     Args.InMesh = "";
     Args.OutMesh = "";
     Args.NumSamples = -1;
+    Args.Seeds = "";
+    Args.Checkpoint = "";
+    Args.CheckpointInterval = 10000;
+    Args.Tolerance = 0.0;
+    Args.Radius = -1.0;
+    Args.RelativeRadius = -1.0;
+    Args.Euclidean = false;
     Args.Resampling = false;
     Args.Evaluate = false;
 
@@ -374,6 +556,85 @@ rmtArgs ParseArgs(int argc, const char* const argv[])
             Args.OutMesh = argv[++i];
             continue;
         }
+        if (argvi == "-s" || argvi == "--seeds")
+        {
+            if (i == argc - 1)
+            {
+                Usage(argv[0], true);
+            }
+            Args.Seeds = argv[++i];
+            continue;
+        }
+        if (argvi == "-c" || argvi == "--checkpoint")
+        {
+            if (i == argc - 1)
+            {
+                Usage(argv[0], true);
+            }
+            Args.Checkpoint = argv[++i];
+            continue;
+        }
+        if (argvi == "-C" || argvi == "--checkpoint-interval")
+        {
+            if (i == argc - 1)
+            {
+                Usage(argv[0], true);
+            }
+            Args.CheckpointInterval = std::stoi(argv[++i]);
+            if (Args.CheckpointInterval <= 0)
+            {
+                std::cerr << "The checkpoint interval must be positive." << std::endl;
+                Usage(argv[0], true);
+            }
+            continue;
+        }
+        if (argvi == "-t" || argvi == "--tolerance")
+        {
+            if (i == argc - 1)
+            {
+                Usage(argv[0], true);
+            }
+            Args.Tolerance = std::stod(argv[++i]);
+            if (Args.Tolerance < 0.0 || Args.Tolerance >= 1.0)
+            {
+                std::cerr << "The sampling tolerance must be in [0, 1)." << std::endl;
+                Usage(argv[0], true);
+            }
+            continue;
+        }
+        if (argvi == "-R" || argvi == "--radius")
+        {
+            if (i == argc - 1)
+            {
+                Usage(argv[0], true);
+            }
+            Args.Radius = std::stod(argv[++i]);
+            if (Args.Radius <= 0.0)
+            {
+                std::cerr << "The sampling radius must be positive." << std::endl;
+                Usage(argv[0], true);
+            }
+            continue;
+        }
+        if (argvi == "-Q" || argvi == "--relative-radius")
+        {
+            if (i == argc - 1)
+            {
+                Usage(argv[0], true);
+            }
+            Args.RelativeRadius = std::stod(argv[++i]);
+            if (Args.RelativeRadius <= 0.0 || Args.RelativeRadius > 1.0)
+            {
+                std::cerr << "The relative sampling radius must be in (0, 1]." << std::endl;
+                Usage(argv[0], true);
+            }
+            continue;
+        }
+        if (argvi == "-u" || argvi == "--euclidean")
+        {
+            Args.Euclidean = true;
+            continue;
+        }
         if (argvi == "-r" || argvi == "--resample")
         {
             Args.Resampling = true;
@@ -395,11 +656,12 @@ rmtArgs ParseArgs(int argc, const char* const argv[])
         std::cerr << "No input mesh given." << std::endl;
         Usage(argv[0], true);
     }
-    if (Args.NumSamples == -1)
+    if (Args.NumSamples == -1 && Args.Radius < 0.0 && Args.RelativeRadius < 0.0)
     {
-        std::cerr << "No output size given." << std::endl;
+        std::cerr << "No output size or sampling radius given." << std::endl;
         Usage(argv[0], true);
     }
+    CheckSizing(Args);
     if (Args.OutMesh.empty())
     {
         Args.OutMesh = std::filesystem::path(Args.InMesh).filename().string();
@@ -420,14 +682,21 @@ void Usage(const std::string& Prog, bool IsError)
     out << std::endl;
     out << Prog << " usage:" << std::endl;
     out << std::endl;
-    out << "\t" << Prog << " input_mesh num_samples [-o|--output out_mesh] [-r|--resample] [-e|--evaluate]" << std::endl;
+    out << "\t" << Prog << " input_mesh [num_samples] [-o|--output out_mesh] [-s|--seeds seeds_file] [-c|--checkpoint ckpt_file] [-C|--checkpoint-interval n] [-t|--tolerance tol] [-R|--radius r] [-Q|--relative-radius q] [-u|--euclidean] [-r|--resample] [-e|--evaluate]" << std::endl;
     out << "\t" << Prog << " -f|--file config_file" << std::endl;
     out << "\t" << Prog << " -h|--help" << std::endl;
     out << std::endl;
     out << "Arguments details:" << std::endl;
     out << "\t- input_mesh is the file containing the mesh to process;" << std::endl;
-    out << "\t- num_samples is the size of the output mesh;" << std::endl;
+    out << "\t- num_samples is the size of the output mesh, or its upper bound when a radius is given;" << std::endl;
     out << "\t- -o|--output sets the output file to out_mesh, by default the base name of input_mesh in the CWD;" << std::endl;
+    out << "\t- -s|--seeds starts the sampling from the vertex indices in seeds_file, such as the -idx.txt files written by BatchRemesh;" << std::endl;
+    out << "\t- -c|--checkpoint saves the state to ckpt_file while running, and resumes from it if it exists;" << std::endl;
+    out << "\t- -C|--checkpoint-interval sets how many samples are added between two checkpoints (default 10000);" << std::endl;
+    out << "\t- -t|--tolerance inserts many samples at once, each within a factor (1 - tol) of the farthest distance, by default 0 (exact sampling);" << std::endl;
+    out << "\t- -R|--radius adds samples until all the vertices are within geodesic distance r from them;" << std::endl;
+    out << "\t- -Q|--relative-radius is the same as -R with r equal to q times the bounding box diagonal;" << std::endl;
+    out << "\t- -u|--euclidean picks the samples with Euclidean distances, faster on dense and nearly convex meshes;" << std::endl;
     out << "\t- -r|--resample applies a resampling of the input mesh for a more uniform remeshing;" << std::endl;
     out << "\t- -e|--evaluate evaluates the resampling quality according to various metrics." << std::endl;
     out << "\t- -f|--file sets the arguments using the content of config_file." << std::endl;
@@ -0,0 +1,457 @@
+/**
+ * @file        contraction.cpp
+ *
+ * @brief       Implements rmt::ContractionHierarchy.
+ *
+ * @author      agent (agent@local)
+ *
+ * @date        2026-10-16
+ */
+#include <rmt/contraction.hpp>
+#include <rmt/queue.hpp>
+#include <rmt/utils.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <cstring>
+
+
+namespace
+{
+
+// Maximum number of nodes settled by a witness search, and of edges on its paths, when
+// estimating the priority of a node and when actually contracting it
+constexpr int SimulationSettleLimit = 50;
+constexpr int SimulationHopLimit = 3;
+constexpr int ContractionSettleLimit = 500;
+constexpr int ContractionHopLimit = 16;
+
+// Header of the binary files
+constexpr char FileMagic[8] = { 'R', 'M', 'T', 'C', 'H', '0', '0', '2' };
+
+typedef std::vector<std::vector<std::pair<int, double>>> DynamicAdjacency;
+
+// Lengths of the edges of the remaining graph, indexed by their endpoints. Edges of contracted
+// nodes are never looked up again, so they are left in the map
+typedef rmt::FlatHashMap<std::uint64_t, double> EdgeLengths;
+
+inline std::uint64_t EdgeKey(int u, int w)
+{
+    return u < w ? rmt::PackPair(u, w) : rmt::PackPair(w, u);
+}
+
+/**
+ * @brief       Local searches for the witness paths of a contraction.
+ */
+class WitnessSearch
+{
+private:
+    const DynamicAdjacency& m_Adj;
+    const EdgeLengths& m_Lengths;
+    rmt::DijkstraWorkspace m_W;
+    std::vector<int> m_Hops;
+    std::vector<int> m_Targets;
+    int m_Stamp;
+
+public:
+    WitnessSearch(const DynamicAdjacency& Adj, const EdgeLengths& Lengths)
+        : m_Adj(Adj), m_Lengths(Lengths), m_W(Adj.size()), m_Hops(Adj.size(), 0), m_Targets(Adj.size(), -1), m_Stamp(0) { }
+
+    /**
+     * @brief       Finds the shortcuts required to contract node v.
+     *
+     * @details     Emit(k, l, Length) is called for each pair of neighbors k < l (as positions
+     *              in the adjacency of v) that is not connected by a witness path avoiding v
+     *              and not longer than the path through v. A direct edge between the two neighbors
+     *              is checked first, with a lookup. The other witnesses are found by a search with
+     *              paths of at most HopLimit edges, which settles at most SettleLimit nodes.
+     *
+     * @return      The number of shortcuts.
+     */
+    template<typename Emitter>
+    int FindShortcuts(int v, int SettleLimit, int HopLimit, Emitter&& Emit)
+    {
+        const auto& Nv = m_Adj[v];
+        int NShortcuts = 0;
+        for (int k = 0; k + 1 < (int)Nv.size(); ++k)
+        {
+            int u = Nv[k].first;
+            double MaxDist = 0.0;
+            int Remaining = 0;
+            m_Stamp++;
+            for (int l = k + 1; l < (int)Nv.size(); ++l)
+            {
+                double Length = Nv[k].second + Nv[l].second;
+                const double* Direct = m_Lengths.Find(EdgeKey(u, Nv[l].first));
+                if (Direct != nullptr && *Direct <= Length)
+                    continue;
+                MaxDist = std::max(MaxDist, Length);
+                m_Targets[Nv[l].first] = m_Stamp;
+                Remaining++;
+            }
+            if (Remaining == 0)
+                continue;
+
+            // Bounded Dijkstra from u in the remaining graph without v, which stops
+            // when all the other neighbors of v are settled
+            m_W.Reset(m_Adj.size());
+            rmt::BinaryHeapQueue& Q = m_W.GetBinaryHeap();
+            m_W.SetDistance(u, 0.0, -1);
+            m_Hops[u] = 0;
+            Q.Push(0.0, u);
+            int Settled = 0;
+            while (!Q.Empty())
+            {
+                int i;
+                double wi;
+                std::tie(wi, i) = Q.Pop();
+                if (wi > m_W.GetDistance(i))
+                    continue;
+                if (wi > MaxDist || ++Settled > SettleLimit)
+                    break;
+                if (m_Targets[i] == m_Stamp && --Remaining == 0)
+                    break;
+                if (m_Hops[i] == HopLimit)
+                    continue;
+
+                for (const auto& e : m_Adj[i])
+                {
+                    int j = e.first;
+                    if (j == v || wi + e.second > MaxDist || m_W.GetDistance(j) <= wi + e.second)
+                        continue;
+                    m_W.SetDistance(j, wi + e.second, i);
+                    m_Hops[j] = m_Hops[i] + 1;
+                    Q.Push(wi + e.second, j);
+                }
+            }
+
+            // Tentative distances are lengths of actual paths, so they are valid witnesses
+            for (int l = k + 1; l < (int)Nv.size(); ++l)
+            {
+                double Length = Nv[k].second + Nv[l].second;
+                if (m_Targets[Nv[l].first] != m_Stamp || m_W.GetDistance(Nv[l].first) <= Length)
+                    continue;
+                Emit(k, l, Length);
+                NShortcuts++;
+            }
+        }
+
+        return NShortcuts;
+    }
+};
+
+/**
+ * @brief       Sets the length of edge (u, w) to Length, unless there is a shorter one.
+ */
+void AddEdge(DynamicAdjacency& Adj, EdgeLengths& Lengths, int u, int w, double Length)
+{
+    auto Ins = Lengths.Insert(EdgeKey(u, w), Length);
+    if (Ins.second)
+    {
+        Adj[u].emplace_back(w, Length);
+        Adj[w].emplace_back(u, Length);
+        return;
+    }
+    if (*Ins.first <= Length)
+        return;
+
+    // A shortcut is rarely shorter than an existing edge, so its copies are searched linearly
+    *Ins.first = Length;
+    for (int x : { u, w })
+    {
+        int y = x == u ? w : u;
+        std::find_if(Adj[x].begin(), Adj[x].end(), [y](const std::pair<int, double>& e) { return e.first == y; })->second = Length;
+    }
+}
+
+} // namespace
+
+
+
+rmt::ContractionHierarchy::ContractionHierarchy() : m_NGraphEdges(0) { }
+
+rmt::ContractionHierarchy::ContractionHierarchy(const rmt::Graph& G)
+{
+    Build(G);
+}
+
+rmt::ContractionHierarchy::~ContractionHierarchy() { }
+
+
+void rmt::ContractionHierarchy::Build(const rmt::Graph& G)
+{
+    int NVerts = G.NumVertices();
+    m_NGraphEdges = G.NumEdges();
+
+    // Graph of the nodes not yet contracted, which grows with the shortcuts
+    DynamicAdjacency Adj(NVerts);
+    EdgeLengths Lengths;
+    Lengths.Reserve(3 * (size_t)m_NGraphEdges);
+    for (int i = 0; i < NVerts; ++i)
+    {
+        for (int j = 0; j < G.NumAdjacents(i); ++j)
+        {
+            if (G.GetNeighbor(i, j) != i)
+                AddEdge(Adj, Lengths, i, G.GetNeighbor(i, j), G.GetWeight(i, j));
+        }
+    }
+
+    // The priority of a node combines its edge difference, the number of its contracted
+    // neighbors and its level in the hierarchy, so that contractions are spread uniformly
+    WitnessSearch Witness(Adj, Lengths);
+    std::vector<int> DeletedNeighbors(NVerts, 0);
+    std::vector<int> Level(NVerts, 0);
+    auto Priority = [&](int v)
+    {
+        int NShortcuts = Witness.FindShortcuts(v, SimulationSettleLimit, SimulationHopLimit, [](int, int, double) { });
+        return (double)(2 * (NShortcuts - (int)Adj[v].size()) + DeletedNeighbors[v] + Level[v]);
+    };
+
+    // Contracting a node only changes the priorities of its neighbors. They are marked, and
+    // estimated again only when they are extracted: if the priority increased, the node is
+    // queued back
+    std::vector<bool> Outdated(NVerts, false);
+    rmt::BinaryHeapQueue Order;
+    Order.Reserve(NVerts);
+    for (int i = 0; i < NVerts; ++i)
+        Order.Push(Priority(i), i);
+
+    m_Rank.assign(NVerts, -1);
+    std::vector<std::vector<std::pair<int, double>>> Upward(NVerts);
+    std::vector<std::pair<std::pair<int, int>, double>> Shortcuts;
+    int NextRank = 0;
+    while (!Order.Empty())
+    {
+        double p;
+        int v;
+        std::tie(p, v) = Order.Pop();
+        if (Outdated[v])
+        {
+            Outdated[v] = false;
+            double NewP = Priority(v);
+            if (NewP > p)
+            {
+                Order.Push(NewP, v);
+                continue;
+            }
+        }
+
+        const auto& Nv = Adj[v];
+        Shortcuts.clear();
+        Witness.FindShortcuts(v, ContractionSettleLimit, ContractionHopLimit, [&](int k, int l, double Length)
+        {
+            Shortcuts.push_back({ { Nv[k].first, Nv[l].first }, Length });
+        });
+
+        // Remove v from the remaining graph
+        for (const auto& e : Nv)
+        {
+            auto& Nu = Adj[e.first];
+            Nu.erase(std::find_if(Nu.begin(), Nu.end(), [v](const std::pair<int, double>& f) { return f.first == v; }));
+            DeletedNeighbors[e.first]++;
+            Level[e.first] = std::max(Level[e.first], Level[v] + 1);
+        }
+        for (const auto& s : Shortcuts)
+            AddEdge(Adj, Lengths, s.first.first, s.first.second, s.second);
+
+        // All the remaining neighbors of v are contracted after it
+        m_Rank[v] = NextRank++;
+        for (const auto& e : Nv)
+            Outdated[e.first] = true;
+        Upward[v].swap(Adj[v]);
+    }
+
+    m_Idxs.resize(NVerts + 1);
+    m_Idxs[0] = 0;
+    for (int i = 0; i < NVerts; ++i)
+        m_Idxs[i + 1] = m_Idxs[i] + Upward[i].size();
+    m_Adjs.resize(m_Idxs[NVerts]);
+    m_Wgts.resize(m_Idxs[NVerts]);
+    for (int i = 0; i < NVerts; ++i)
+    {
+        for (int j = 0; j < (int)Upward[i].size(); ++j)
+        {
+            m_Adjs[m_Idxs[i] + j] = Upward[i][j].first;
+            m_Wgts[m_Idxs[i] + j] = Upward[i][j].second;
+        }
+        std::vector<std::pair<int, double>>().swap(Upward[i]);
+    }
+}
+
+
+bool rmt::ContractionHierarchy::Save(const std::string& Filename) const
+{
+    return rmt::WriteFileSafely(Filename, [&](std::ostream& Stream)
+    {
+        int NVerts = NumVertices();
+        int NAdjs = m_Adjs.size();
+        Stream.write(FileMagic, sizeof(FileMagic));
+        Stream.write((const char*)&NVerts, sizeof(int));
+        Stream.write((const char*)&m_NGraphEdges, sizeof(int));
+        Stream.write((const char*)&NAdjs, sizeof(int));
+        Stream.write((const char*)m_Rank.data(), sizeof(int) * NVerts);
+        Stream.write((const char*)m_Idxs.data(), sizeof(int) * (NVerts + 1));
+        Stream.write((const char*)m_Adjs.data(), sizeof(int) * NAdjs);
+        Stream.write((const char*)m_Wgts.data(), sizeof(double) * NAdjs);
+        return Stream.good();
+    });
+}
+
+bool rmt::ContractionHierarchy::Load(const std::string& Filename, const rmt::Graph& G)
+{
+    std::ifstream Stream(Filename, std::ios::binary);
+    if (!Stream.is_open())
+        return false;
+
+    char Magic[sizeof(FileMagic)];
+    int NVerts;
+    int NGraphEdges;
+    int NAdjs;
+    Stream.read(Magic, sizeof(Magic));
+    Stream.read((char*)&NVerts, sizeof(int));
+    Stream.read((char*)&NGraphEdges, sizeof(int));
+    Stream.read((char*)&NAdjs, sizeof(int));
+    if (!Stream.good() || std::memcmp(Magic, FileMagic, sizeof(FileMagic)) != 0 ||
+        NVerts != G.NumVertices() || NGraphEdges != G.NumEdges())
+        return false;
+
+    // Each pair of nodes has at most one upward edge, and the arrays must fill the rest of
+    // the file, so a corrupted header cannot trigger allocations larger than the file itself
+    std::streamoff Header = Stream.tellg();
+    Stream.seekg(0, std::ios::end);
+    long long Payload = (long long)(Stream.tellg() - Header);
+    Stream.seekg(Header);
+    long long MaxAdjs = (long long)NVerts * (NVerts - 1) / 2;
+    if (!Stream.good() || NAdjs < 0 || NAdjs > MaxAdjs ||
+        Payload != (long long)sizeof(int) * (2LL * NVerts + 1 + NAdjs) + (long long)sizeof(double) * NAdjs)
+        return false;
+
+    std::vector<int> Rank(NVerts);
+    Stream.read((char*)Rank.data(), sizeof(int) * NVerts);
+    if (!Stream.good())
+        return false;
+    std::vector<int> Idxs(NVerts + 1);
+    Stream.read((char*)Idxs.data(), sizeof(int) * (NVerts + 1));
+    if (!Stream.good())
+        return false;
+    std::vector<int> Adjs(NAdjs);
+    Stream.read((char*)Adjs.data(), sizeof(int) * NAdjs);
+    if (!Stream.good())
+        return false;
+    std::vector<double> Wgts(NAdjs);
+    Stream.read((char*)Wgts.data(), sizeof(double) * NAdjs);
+    if (!Stream.good())
+        return false;
+
+    // The hierarchy is left untouched by a corrupted file: the ranks must be a permutation,
+    // the offsets must be monotone, and each edge must lead to a higher node with a valid length
+    std::vector<bool> Ranked(NVerts, false);
+    for (int r : Rank)
+    {
+        if (r < 0 || r >= NVerts || Ranked[r])
+            return false;
+        Ranked[r] = true;
+    }
+    if (Idxs[0] != 0 || Idxs[NVerts] != NAdjs)
+        return false;
+    for (int i = 0; i < NVerts; ++i)
+    {
+        if (Idxs[i + 1] < Idxs[i])
+            return false;
+        for (int jj = Idxs[i]; jj < Idxs[i + 1]; ++jj)
+        {
+            int j = Adjs[jj];
+            if (j < 0 || j >= NVerts || Rank[j] <= Rank[i] || !std::isfinite(Wgts[jj]) || Wgts[jj] < 0.0)
+                return false;
+        }
+    }
+
+    m_Rank = std::move(Rank);
+    m_Idxs = std::move(Idxs);
+    m_Adjs = std::move(Adjs);
+    m_Wgts = std::move(Wgts);
+    m_NGraphEdges = NGraphEdges;
+
+    return true;
+}
+
+
+int rmt::ContractionHierarchy::NumVertices() const { return m_Rank.size(); }
+int rmt::ContractionHierarchy::NumEdges() const { return m_Adjs.size(); }
+int rmt::ContractionHierarchy::GetRank(int i) const { return m_Rank[i]; }
+
+
+double rmt::ContractionHierarchy::Distance(int src, int dst) const
+{
+    rmt::DijkstraWorkspace Fwd;
+    rmt::DijkstraWorkspace Bwd;
+    return Distance(src, dst, Fwd, Bwd);
+}
+
+double rmt::ContractionHierarchy::Distance(int src, int dst, rmt::DijkstraWorkspace& Fwd,
+                                           rmt::DijkstraWorkspace& Bwd) const
+{
+    Fwd.Reset(NumVertices());
+    Bwd.Reset(NumVertices());
+
+    // Both searches only move upwards, so each of them is a plain Dijkstra with monotone keys
+    rmt::RadixHeapQueue* Q[2] = { &Fwd.GetRadixHeap(), &Bwd.GetRadixHeap() };
+    rmt::DijkstraWorkspace* W[2] = { &Fwd, &Bwd };
+    bool Done[2] = { false, false };
+    double Best = std::numeric_limits<double>::infinity();
+
+    Fwd.SetDistance(src, 0.0, -1);
+    Bwd.SetDistance(dst, 0.0, -1);
+    Q[0]->Push(0.0, src);
+    Q[1]->Push(0.0, dst);
+
+    int Dir = 1;
+    while (!Done[0] || !Done[1])
+    {
+        // Alternate the directions, unless one of them is over
+        if (!Done[1 - Dir])
+            Dir = 1 - Dir;
+        rmt::DijkstraWorkspace& This = *W[Dir];
+        rmt::DijkstraWorkspace& Other = *W[1 - Dir];
+
+        if (Q[Dir]->Empty())
+        {
+            Done[Dir] = true;
+            continue;
+        }
+        int i;
+        double wi;
+        std::tie(wi, i) = Q[Dir]->Pop();
+        if (wi > This.GetDistance(i))
+            continue;
+        // No path through the remaining nodes can improve the best one
+        if (wi >= Best)
+        {
+            Done[Dir] = true;
+            continue;
+        }
+        if (Other.IsReached(i))
+            Best = std::min(Best, wi + Other.GetDistance(i));
+
+        // Stall-on-demand: if a higher node reaches i with a shorter path, wi is not the
+        // distance of i and the search does not need to continue from it
+        bool Stalled = false;
+        for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1] && !Stalled; ++jj)
+            Stalled = This.GetDistance(m_Adjs[jj]) + m_Wgts[jj] < wi;
+        if (Stalled)
+            continue;
+
+        for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+        {
+            int j = m_Adjs[jj];
+            double wj = m_Wgts[jj];
+            if (This.GetDistance(j) <= wi + wj)
+                continue;
+            This.SetDistance(j, wi + wj, i);
+            Q[Dir]->Push(wi + wj, j);
+        }
+    }
+
+    return Best;
+}
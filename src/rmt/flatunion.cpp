@@ -10,142 +10,295 @@
  * @date        2024-01-15
  */
 #include <rmt/flatunion.hpp>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <limits>
 
 
-rmt::FlatUnion::FlatUnion(const rmt::Mesh& M, rmt::VoronoiPartitioning& VPart)
-    : m_Mesh(M), m_VPart(VPart) { }
+namespace
+{
+
+// Header of the checkpoints
+constexpr char FileMagic[8] = { 'R', 'M', 'T', 'F', 'U', '0', '0', '1' };
+
+} // namespace
+
+
+rmt::FlatUnion::FlatUnion(const rmt::Mesh& M, rmt::VoronoiPartitioning& VPart, int NumThreads)
+    : m_Mesh(M), m_VPart(VPart), m_Iterations(0), m_Incremental(false),
+      m_Pool(rmt::NumThreadsFor(NumThreads, M.NumTriangles())) { }
 
 rmt::FlatUnion::~FlatUnion() { }
 
 
-void rmt::FlatUnion::DetermineRegions()
+void rmt::FlatUnion::BuildIncidence()
 {
-    int NSamples = m_VPart.NumSamples();
-    m_Midpoints.clear();
-    m_Midpoints.reserve(3 * NSamples);
-    m_BoundBreak.clear();
-    m_BoundBreak.reserve(3 * NSamples);
-    m_RDict.Clear(NSamples);
-
-    // Add a region for each sample point
-    for (int i = 0; i < NSamples; ++i)
-        m_RDict.AddRegion(i);
-
-    m_Farthests.clear();
-    m_Farthests.resize(NSamples);
-    for (int i = 0; i < NSamples; ++i)
-        m_Farthests[i] = { m_VPart.GetSample(i), 0.0 };
-
-    int NFaces = m_Mesh.NumTriangles();
+    int NVerts = m_Mesh.NumVertices();
     const Eigen::MatrixXi& F = m_Mesh.GetTriangles();
-    const Eigen::VectorXi& P = m_VPart.GetPartitions();
-    const Eigen::VectorXd& D = m_VPart.GetDistances();
-    for (int i = 0; i < NFaces; ++i)
+    m_VFIdx.assign(NVerts + 1, 0);
+    for (int i = 0; i < F.rows(); ++i)
     {
-        // Update farthests inside regions
         for (int j = 0; j < 3; ++j)
+            m_VFIdx[F(i, j) + 1]++;
+    }
+    for (int v = 0; v < NVerts; ++v)
+        m_VFIdx[v + 1] += m_VFIdx[v];
+
+    // The faces of each vertex are sorted by index
+    std::vector<int> Next(m_VFIdx.begin(), m_VFIdx.end() - 1);
+    m_VFAdj.resize(m_VFIdx[NVerts]);
+    for (int i = 0; i < F.rows(); ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+            m_VFAdj[Next[F(i, j)]++] = i;
+    }
+}
+
+
+void rmt::FlatUnion::AddFace(int i, FaceRegions* Local)
+{
+    const Eigen::MatrixXi& F = m_Mesh.GetTriangles();
+    const Eigen::VectorXi& P = m_VPart.GetPartitions();
+    const rmt::DistanceVector& D = m_VPart.GetDistances();
+
+    // The incremental iterations only update the regions containing a changed cell
+    auto Changed = [&](int p) { return !m_Incremental || m_Dirty[p]; };
+
+    // The regions of the other threads are added to the dictionary when merging
+    std::vector<std::pair<int, double>>& Farthests = Local == nullptr ? m_Farthests : Local->Farthests;
+    auto& BoundBreak = Local == nullptr ? m_BoundBreak : Local->BoundBreak;
+    auto& MidpointMap = Local == nullptr ? m_Midpoints : Local->Midpoints;
+    auto AddRegion = [&](int pi, int pj, int pk)
+    {
+        if (Local != nullptr)
+            Local->Regions.emplace_back(pi, pj, pk);
+        else if (pk == std::numeric_limits<int>::max())
+            m_RDict.AddRegion(pi, pj);
+        else
+            m_RDict.AddRegion(pi, pj, pk);
+    };
+
+    // Update farthests inside regions
+    for (int j = 0; j < 3; ++j)
+    {
+        int v = F(i, j);
+        int p = P[v];
+        if (D[v] > Farthests[p].second && Changed(p))
+            Farthests[p] = { v, D[v] };
+    }
+
+    int p0 = P[F(i, 0)];
+    int p1 = P[F(i, 1)];
+    int p2 = P[F(i, 2)];
+
+    // If triangle crosses two regions, add the union region 
+    // and update the eventual breakpoint
+    if (p0 != p1 && (Changed(p0) || Changed(p1)))
+    {
+        std::uint64_t p01 = p0 < p1 ? rmt::PackPair(p0, p1) : rmt::PackPair(p1, p0);
+        std::pair<int, double> v01{F(i, 0), D[F(i, 0)]};
+        if (D[F(i, 1)] > v01.second)
+            v01 = { F(i, 1), D[F(i, 1)] };
+        auto Ins = BoundBreak.Insert(p01, v01);
+        if (Ins.second)
+            AddRegion(p0, p1, std::numeric_limits<int>::max());
+        else if (v01.second > Ins.first->second)
+            *Ins.first = v01;
+    }
+    if (p1 != p2 && (Changed(p1) || Changed(p2)))
+    {
+        std::uint64_t p12 = p1 < p2 ? rmt::PackPair(p1, p2) : rmt::PackPair(p2, p1);
+        std::pair<int, double> v12{F(i, 1), D[F(i, 1)]};
+        if (D[F(i, 2)] > v12.second)
+            v12 = { F(i, 2), D[F(i, 2)] };
+        auto Ins = BoundBreak.Insert(p12, v12);
+        if (Ins.second)
+            AddRegion(p1, p2, std::numeric_limits<int>::max());
+        else if (v12.second > Ins.first->second)
+            *Ins.first = v12;
+    }
+    if (p2 != p0 && (Changed(p2) || Changed(p0)))
+    {
+        std::uint64_t p20 = p2 < p0 ? rmt::PackPair(p2, p0) : rmt::PackPair(p0, p2);
+        std::pair<int, double> v20{F(i, 2), D[F(i, 2)]};
+        if (D[F(i, 0)] > v20.second)
+            v20 = { F(i, 0), D[F(i, 0)] };
+        auto Ins = BoundBreak.Insert(p20, v20);
+        if (Ins.second)
+            AddRegion(p2, p0, std::numeric_limits<int>::max());
+        else if (v20.second > Ins.first->second)
+            *Ins.first = v20;
+    }
+
+    // If triangle not crossing three regions, skip
+    if (p0 == p1)
+        return;
+    if (p1 == p2)
+        return;
+    if (p2 == p0)
+        return;
+    if (!Changed(p0) && !Changed(p1) && !Changed(p2))
+        return;
+
+    // Add the midpoint
+    rmt::RegionDictionary::OrderIndices(p0, p1, p2);
+    auto Ins = MidpointMap.Insert(rmt::PackTriple(p0, p1, p2), {});
+    std::vector<int>& Midpoints = *Ins.first;
+    // Order the indices by distance to the sample set
+    int v0 = F(i, 0);
+    int v1 = F(i, 1);
+    int v2 = F(i, 2);
+    if (D[v0] < D[v1])
+        std::swap(v0, v1);
+    if (D[v1] < D[v2])
+    {
+        std::swap(v1, v2);
+        if (D[v0] < D[v1])
+            std::swap(v0, v1);
+    }
+    // Additional check: if all the vertices are samples, this is going to be
+    // a triangle in the final mesh, and we are not going to add the midpoint
+    // to the list of new samples candidates
+    if (v0 != m_VPart.GetSample(P[v0]))
+        Midpoints.emplace_back(v0);
+    else if (v1 != m_VPart.GetSample(P[v1]))
+        Midpoints.emplace_back(v1);
+    else if (v2 != m_VPart.GetSample(P[v2]))
+        Midpoints.emplace_back(v2);
+
+    // Add the region
+    if (Ins.second)
+        AddRegion(p0, p1, p2);
+}
+
+void rmt::FlatUnion::AddFaces()
+{
+    int NSamples = m_VPart.NumSamples();
+    const std::vector<int>& Changed = m_VPart.GetChangedCells();
+    int NFaces = m_Incremental ? (int)m_Faces.size() : m_Mesh.NumTriangles();
+    int NThreads = m_Pool.NumThreads();
+    size_t SizeHint = (m_Incremental ? 6 * Changed.size() : 3 * (size_t)NSamples) / NThreads;
+    m_Local.resize(NThreads);
+
+    rmt::ParallelFor(m_Pool, 0, NFaces, [&](int ThreadID, int Begin, int End)
+    {
+        FaceRegions* Local = nullptr;
+        if (ThreadID > 0)
         {
-            int v = F(i, j);
-            int p = P[v];
-            if (D[v] > m_Farthests[p].second)
-                m_Farthests[p] = { v, D[v] };
+            Local = &m_Local[ThreadID];
+            Local->Farthests.resize(NSamples, { -1, 0.0 });
+            Local->BoundBreak.Clear(SizeHint);
+            Local->Midpoints.Clear(SizeHint);
+            Local->Regions.clear();
         }
+        for (int k = Begin; k < End; ++k)
+            AddFace(m_Incremental ? m_Faces[k] : k, Local);
+    });
 
-        int p0 = P[F(i, 0)];
-        int p1 = P[F(i, 1)];
-        int p2 = P[F(i, 2)];
+    // Merge the ranges in order: the first of the farthest vertices, breakpoints and regions
+    // found is kept, as when visiting all the faces in a row
+    int NCells = m_Incremental ? (int)Changed.size() : NSamples;
+    for (int t = 1; t < NThreads; ++t)
+    {
+        FaceRegions& Local = m_Local[t];
+        for (int c = 0; c < NCells; ++c)
+        {
+            int p = m_Incremental ? Changed[c] : c;
+            if (Local.Farthests[p].second > m_Farthests[p].second)
+                m_Farthests[p] = Local.Farthests[p];
+            Local.Farthests[p] = { -1, 0.0 };
+        }
 
-        // If triangle crosses two regions, add the union region 
-        // and update the eventual breakpoint
-        if (p0 != p1)
+        for (const auto& e : Local.BoundBreak)
         {
-            std::pair<int, int> p01{p0, p1};
-            if (p1 < p0)
-                std::swap(p01.first, p01.second);
-            std::pair<int, double> v01{F(i, 0), D[F(i, 0)]};
-            if (D[F(i, 1)] > v01.second)
-                v01 = { F(i, 1), D[F(i, 1)] };
-            if (m_BoundBreak.find(p01) == m_BoundBreak.end())
-            {
-                m_RDict.AddRegion(p0, p1);
-                m_BoundBreak.emplace(p01, v01);
-            }
-            if (v01.second > m_BoundBreak[p01].second)
-                m_BoundBreak[p01] = v01;
+            auto Ins = m_BoundBreak.Insert(e.first, e.second);
+            if (!Ins.second && e.second.second > Ins.first->second)
+                *Ins.first = e.second;
         }
-        if (p1 != p2)
+
+        for (const auto& m : Local.Midpoints)
         {
-            std::pair<int, int> p12{p1, p2};
-            if (p2 < p1)
-                std::swap(p12.first, p12.second);
-            std::pair<int, double> v12{F(i, 1), D[F(i, 1)]};
-            if (D[F(i, 2)] > v12.second)
-                v12 = { F(i, 2), D[F(i, 2)] };
-            if (m_BoundBreak.find(p12) == m_BoundBreak.end())
-            {
-                m_RDict.AddRegion(p1, p2);
-                m_BoundBreak.emplace(p12, v12);
-            }
-            if (v12.second > m_BoundBreak[p12].second)
-                m_BoundBreak[p12] = v12;
+            std::vector<int>& Midpoints = *m_Midpoints.Insert(m.first, {}).first;
+            Midpoints.insert(Midpoints.end(), m.second.begin(), m.second.end());
         }
-        if (p2 != p0)
+
+        for (const auto& r : Local.Regions)
         {
-            std::pair<int, int> p20{p2, p0};
-            if (p0 < p2)
-                std::swap(p20.first, p20.second);
-            std::pair<int, double> v20{F(i, 2), D[F(i, 2)]};
-            if (D[F(i, 0)] > v20.second)
-                v20 = { F(i, 0), D[F(i, 0)] };
-            if (m_BoundBreak.find(p20) == m_BoundBreak.end())
-            {
-                m_RDict.AddRegion(p2, p0);
-                m_BoundBreak.emplace(p20, v20);
-            }
-            if (v20.second > m_BoundBreak[p20].second)
-                m_BoundBreak[p20] = v20;
+            if (std::get<2>(r) == std::numeric_limits<int>::max())
+                m_RDict.AddRegion(std::get<0>(r), std::get<1>(r));
+            else
+                m_RDict.AddRegion(std::get<0>(r), std::get<1>(r), std::get<2>(r));
         }
+    }
+}
 
-        // If triangle not crossing three regions, skip
-        if (p0 == p1)
-            continue;
-        if (p1 == p2)
-            continue;
-        if (p2 == p0)
-            continue;
 
-        // Add the midpoint
-        rmt::RegionDictionary::OrderIndices(p0, p1, p2);
-        std::tuple<int, int, int> T(p0, p1, p2);
-        if (m_Midpoints.find(T) == m_Midpoints.end())
-            m_Midpoints.emplace(T, std::vector<int>{});
-        // Order the indices by distance to the sample set
-        int v0 = F(i, 0);
-        int v1 = F(i, 1);
-        int v2 = F(i, 2);
-        if (D[v0] < D[v1])
-            std::swap(v0, v1);
-        if (D[v1] < D[v2])
+void rmt::FlatUnion::DetermineRegions()
+{
+    int NSamples = m_VPart.NumSamples();
+    const std::vector<int>& Changed = m_VPart.GetChangedCells();
+    m_Incremental = !m_Farthests.empty() && 2 * Changed.size() <= (size_t)NSamples;
+
+    if (!m_Incremental)
+    {
+        m_Midpoints.Clear(3 * NSamples);
+        m_BoundBreak.Clear(3 * NSamples);
+        m_RDict.Clear(NSamples);
+
+        // Add a region for each sample point
+        for (int i = 0; i < NSamples; ++i)
+            m_RDict.AddRegion(i);
+
+        m_Farthests.clear();
+        m_Farthests.resize(NSamples);
+        for (int i = 0; i < NSamples; ++i)
+            m_Farthests[i] = { m_VPart.GetSample(i), 0.0 };
+
+        AddFaces();
+    }
+    else
+    {
+        // A cell is usually adjacent to about six others
+        int NChanged = Changed.size();
+        m_Midpoints.Clear(6 * NChanged);
+        m_BoundBreak.Clear(6 * NChanged);
+        m_RDict.Clear(NSamples, 6 * NChanged);
+
+        m_Dirty.resize(NSamples, false);
+        m_Farthests.resize(NSamples);
+        for (int c : Changed)
+        {
+            m_Dirty[c] = true;
+            m_RDict.AddRegion(c);
+            m_Farthests[c] = { m_VPart.GetSample(c), 0.0 };
+        }
+
+        // Every region containing a changed cell has a face incident to one of its vertices.
+        // The faces are visited in the same order as in the whole mesh, so ties are broken
+        // in the same way.
+        if (m_VFIdx.empty())
+            BuildIncidence();
+        const Eigen::VectorXi& P = m_VPart.GetPartitions();
+        m_Faces.clear();
+        for (int c : Changed)
         {
-            std::swap(v1, v2);
-            if (D[v0] < D[v1])
-                std::swap(v0, v1);
+            for (int v : m_VPart.GetCellVertices(c))
+            {
+                if (P[v] == c)
+                    m_Faces.insert(m_Faces.end(), m_VFAdj.begin() + m_VFIdx[v], m_VFAdj.begin() + m_VFIdx[v + 1]);
+            }
         }
-        // Additional check: if all the vertices are samples, this is going to be
-        // a triangle in the final mesh, and we are not going to add the midpoint
-        // to the list of new samples candidates
-        if (v0 != m_VPart.GetSample(P[v0]))
-            m_Midpoints[T].emplace_back(v0);
-        else if (v1 != m_VPart.GetSample(P[v1]))
-            m_Midpoints[T].emplace_back(v1);
-        else if (v2 != m_VPart.GetSample(P[v2]))
-            m_Midpoints[T].emplace_back(v2);
-
-        // Add the region
-        m_RDict.AddRegion(p0, p1, p2);
+        std::sort(m_Faces.begin(), m_Faces.end());
+        m_Faces.erase(std::unique(m_Faces.begin(), m_Faces.end()), m_Faces.end());
+        AddFaces();
+
+        for (int c : Changed)
+            m_Dirty[c] = false;
     }
 
-    m_RDict.BuildRegionMaps();
+    m_VPart.ClearChangedCells();
+    m_RDict.BuildRegionMaps(m_Pool.NumThreads());
 }
 
 
@@ -155,41 +308,145 @@ void rmt::FlatUnion::ComputeTopologies()
 {
     const Eigen::VectorXi& P = m_VPart.GetPartitions();
 
+    if (m_Incremental)
+    {
+        ComputeChangedTopologies();
+        return;
+    }
 
+
+    // Each thread counts a range of the elements with its own counters
     int NVerts = m_Mesh.NumVertices();
     const Eigen::VectorXi& BV = m_Mesh.GetBoundaryVertices();
-    for (int i = 0; i < NVerts; ++i)
-    {
-        CUTAssert(P[i] < m_VPart.NumSamples());
-        CUTAssert(P[i] >= 0);
-        if (!BV[i])
-            m_RDict.AddVertex(P[i]);
-        // Boundary vertices do not contribute to topological changes
-        // else
-        //     m_RDict.AddBoundaryVertex(P[i]);
-    }
+    rmt::ParallelFor(m_Pool, 0, NVerts, [&](int ThreadID, int Begin, int End)
+    {
+        for (int i = Begin; i < End; ++i)
+        {
+            CUTAssert(P[i] < m_VPart.NumSamples());
+            CUTAssert(P[i] >= 0);
+            if (!BV[i])
+                m_RDict.AddVertex(P[i], ThreadID);
+            // Boundary vertices do not contribute to topological changes
+            // else
+            //     m_RDict.AddBoundaryVertex(P[i]);
+        }
+    });
 
     const Eigen::MatrixXi& E = m_Mesh.GetEdges();
     const Eigen::VectorXi& BE = m_Mesh.GetBoundaryEdges();
     int NEdges = E.rows();
-    for (int i = 0; i < NEdges; ++i)
+    rmt::ParallelFor(m_Pool, 0, NEdges, [&](int ThreadID, int Begin, int End)
     {
-        if (!BE[i])
-            m_RDict.AddEdge(P[E(i, 0)], P[E(i, 1)]);
-        // Boundary edges do not contribute to topological changes
-        // else
-        //     m_RDict.AddBoundaryEdge(P[E(i, 0)], P[E(i, 1)]);
-    }
+        for (int i = Begin; i < End; ++i)
+        {
+            if (!BE[i])
+                m_RDict.AddEdge(P[E(i, 0)], P[E(i, 1)], ThreadID);
+            // Boundary edges do not contribute to topological changes
+            // else
+            //     m_RDict.AddBoundaryEdge(P[E(i, 0)], P[E(i, 1)]);
+        }
+    });
 
     const Eigen::MatrixXi& F = m_Mesh.GetTriangles();
     int NTris = F.rows();
-    for (int i = 0; i < NTris; ++i)
-        m_RDict.AddTriangle(P[F(i, 0)], P[F(i, 1)], P[F(i, 2)]);
+    rmt::ParallelFor(m_Pool, 0, NTris, [&](int ThreadID, int Begin, int End)
+    {
+        for (int i = Begin; i < End; ++i)
+            m_RDict.AddTriangle(P[F(i, 0)], P[F(i, 1)], P[F(i, 2)], ThreadID);
+    });
+
+    m_RDict.ReduceCounts();
+}
+
+
+void rmt::FlatUnion::ComputeChangedTopologies()
+{
+    // The cells of the regions to update, which are the changed cells and their neighbors
+    int NSamples = m_VPart.NumSamples();
+    m_Scan.resize(NSamples, false);
+    m_ScanCells.clear();
+    size_t NRegions = m_RDict.NumRegions();
+    for (size_t i = 0; i < NRegions; ++i)
+    {
+        std::tuple<int, int, int> T = m_RDict.GetRegion(i).GetSamples();
+        for (int p : { std::get<0>(T), std::get<1>(T), std::get<2>(T) })
+        {
+            if (p < NSamples && !m_Scan[p])
+            {
+                m_Scan[p] = true;
+                m_ScanCells.emplace_back(p);
+            }
+        }
+    }
+
+    // Every vertex, edge and triangle of the regions has a vertex in one of those cells,
+    // and it is counted exactly once
+    const Eigen::VectorXi& P = m_VPart.GetPartitions();
+    const Eigen::VectorXi& BV = m_Mesh.GetBoundaryVertices();
+    const Eigen::MatrixXi& F = m_Mesh.GetTriangles();
+    int NScan = m_ScanCells.size();
+    rmt::ParallelFor(m_Pool, 0, NScan, [&](int ThreadID, int Begin, int End)
+    {
+        for (int s = Begin; s < End; ++s)
+        {
+            int c = m_ScanCells[s];
+            for (int v : m_VPart.GetCellVertices(c))
+            {
+                if (P[v] != c)
+                    continue;
+                // Boundary vertices do not contribute to topological changes
+                if (!BV[v])
+                    m_RDict.AddVertex(c, ThreadID);
+
+                for (int k = m_VFIdx[v]; k < m_VFIdx[v + 1]; ++k)
+                {
+                    int f = m_VFAdj[k];
+                    if (k > m_VFIdx[v] && m_VFAdj[k - 1] == f)
+                        continue;
+
+                    // A triangle is counted from its first vertex in one of the cells
+                    int First = 0;
+                    while (!m_Scan[P[F(f, First)]])
+                        First++;
+                    if (F(f, First) == v)
+                        m_RDict.AddTriangle(P[F(f, 0)], P[F(f, 1)], P[F(f, 2)], ThreadID);
+
+                    // An edge is counted from its first triangle, and from its smaller endpoint if both
+                    // are in the cells. As in rmt::Mesh, it is a boundary edge if it has one triangle.
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        int u = F(f, j);
+                        if (u == v || (u < v && m_Scan[P[u]]))
+                            continue;
+                        int NTris = 0;
+                        int FirstTri = -1;
+                        for (int h = m_VFIdx[v]; h < m_VFIdx[v + 1]; ++h)
+                        {
+                            int g = m_VFAdj[h];
+                            if (F(g, 0) != u && F(g, 1) != u && F(g, 2) != u)
+                                continue;
+                            if (NTris == 0)
+                                FirstTri = g;
+                            NTris++;
+                        }
+                        // Boundary edges do not contribute to topological changes
+                        if (FirstTri == f && NTris > 1)
+                            m_RDict.AddEdge(c, P[u], ThreadID);
+                    }
+                }
+            }
+        }
+    });
+    m_RDict.ReduceCounts();
+
+    for (int c : m_ScanCells)
+        m_Scan[c] = false;
 }
 
 
 bool rmt::FlatUnion::FixIssues()
 {
+    m_Iterations++;
     std::set<int> NewSamples;
 
     // For each region that is not a closed 2-ball, fix it
@@ -214,7 +471,7 @@ bool rmt::FlatUnion::FixIssues()
         {
             int p0 = std::get<0>(T);
             int p1 = std::get<1>(T);
-            int v = m_BoundBreak[{ p0, p1 }].first;
+            int v = m_BoundBreak.Find(rmt::PackPair(p0, p1))->first;
             // A sample cannot insert itself
             if (m_VPart.GetSample(p0) == v)
                 continue;
@@ -224,7 +481,8 @@ bool rmt::FlatUnion::FixIssues()
             continue;
         }
         // If is a union of three texels, add all the midpoints
-        NewSamples.insert(m_Midpoints[T].begin(), m_Midpoints[T].end());
+        const std::vector<int>& Midpoints = *m_Midpoints.Find(rmt::PackTriple(std::get<0>(T), std::get<1>(T), std::get<2>(T)));
+        NewSamples.insert(Midpoints.begin(), Midpoints.end());
     }
 
     // Add the samples
@@ -232,4 +490,37 @@ bool rmt::FlatUnion::FixIssues()
         m_VPart.AddSample(v);
 
     return NewSamples.size() == 0;
+}
+
+
+int rmt::FlatUnion::NumIterations() const { return m_Iterations; }
+
+
+bool rmt::FlatUnion::Save(const std::string& Filename) const
+{
+    return rmt::WriteFileSafely(Filename, [&](std::ostream& Stream)
+    {
+        Stream.write(FileMagic, sizeof(FileMagic));
+        Stream.write((const char*)&m_Iterations, sizeof(int));
+        return m_VPart.Save(Stream);
+    });
+}
+
+bool rmt::FlatUnion::Load(const std::string& Filename)
+{
+    std::ifstream Stream(Filename, std::ios::binary);
+    if (!Stream.is_open())
+        return false;
+
+    char Magic[sizeof(FileMagic)];
+    int Iterations;
+    Stream.read(Magic, sizeof(Magic));
+    Stream.read((char*)&Iterations, sizeof(int));
+    if (!Stream.good() || std::memcmp(Magic, FileMagic, sizeof(FileMagic)) != 0 || Iterations < 0)
+        return false;
+    if (!m_VPart.Load(Stream))
+        return false;
+
+    m_Iterations = Iterations;
+    return true;
 }
\ No newline at end of file
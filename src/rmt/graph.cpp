@@ -10,10 +10,14 @@
  * @date        2023-07-17
  */
 #include <rmt/graph.hpp>
+#include <rmt/queue.hpp>
+#include <rmt/parallel.hpp>
 #include <cut/cut.hpp>
 #include <set>
 #include <queue>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 
 
 using namespace rmt;
@@ -21,150 +25,205 @@ using namespace rmt;
 typedef std::pair<int, int> Edge;  // Mesh edges
 
 
-Graph::Graph(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F)
+namespace
 {
-    int nVerts = V.rows();
-    // m_Verts.resize(nVerts);
-    // for (int i = 0; i < nVerts; ++i)
-    //     m_Verts[i] = V.row(i).segment<3>(0);
 
-    // std::set<Edge> Edges;
-    std::vector<Edge> Edges;
-    Edges.reserve(6 * F.rows());
-    int nTris = F.rows();
-    for (int i = 0; i < nTris; ++i)
+/**
+ * @brief       Groups values by key with a parallel counting sort.
+ * 
+ * @details     Emit(i, Add) must call Add(Key, Value) for every pair produced by the
+ *              i-th item. The values with key k are stored in Values[Offsets[k]] to
+ *              Values[Offsets[k + 1] - 1], in no particular order.
+ */
+template<typename Emitter>
+void CountingSort(rmt::ThreadPool& Pool, int NKeys, int NItems, Emitter&& Emit,
+                  std::vector<int>& Offsets, std::vector<int>& Values)
+{
+    std::vector<std::atomic<int>> Cursor(NKeys);
+    for (int k = 0; k < NKeys; ++k)
+        Cursor[k].store(0, std::memory_order_relaxed);
+
+    // Count the values of each key
+    rmt::ParallelFor(Pool, 0, NItems, [&](int, int Begin, int End)
     {
-        Edges.emplace_back(F(i, 0), F(i, 1));
-        Edges.emplace_back(F(i, 1), F(i, 2));
-        Edges.emplace_back(F(i, 2), F(i, 0));
+        for (int i = Begin; i < End; ++i)
+            Emit(i, [&](int Key, int) { Cursor[Key].fetch_add(1, std::memory_order_relaxed); });
+    });
 
-        Edges.emplace_back(F(i, 1), F(i, 0));
-        Edges.emplace_back(F(i, 2), F(i, 1));
-        Edges.emplace_back(F(i, 0), F(i, 2));
+    Offsets.resize(NKeys + 1);
+    Offsets[0] = 0;
+    for (int k = 0; k < NKeys; ++k)
+    {
+        Offsets[k + 1] = Offsets[k] + Cursor[k].load(std::memory_order_relaxed);
+        Cursor[k].store(Offsets[k], std::memory_order_relaxed);
     }
-    std::sort(Edges.begin(), Edges.end());
-    auto EEnd = std::unique(Edges.begin(), Edges.end());
 
-    m_Idxs.resize(nVerts + 1);
-    // m_Adjs.reserve(Edges.size());
-    m_Adjs.reserve(std::distance(Edges.begin(), EEnd) + 1);
-    int CurNode = 0;
-    Eigen::Vector3d CurVert = V.row(0);// m_Verts[0];
-    for (auto it = Edges.begin(); it != EEnd; it++)
+    // Scatter the values
+    Values.resize(Offsets[NKeys]);
+    rmt::ParallelFor(Pool, 0, NItems, [&](int, int Begin, int End)
+    {
+        for (int i = Begin; i < End; ++i)
+            Emit(i, [&](int Key, int Value) { Values[Cursor[Key].fetch_add(1, std::memory_order_relaxed)] = Value; });
+    });
+}
+
+/**
+ * @brief       Builds a compressed sparse row adjacency.
+ * 
+ * @details     Gather(i, Buffer) must append the neighbors of node i to Buffer, possibly
+ *              with repetitions. Each adjacency list is sorted and without duplicates.\n
+ *              Lists are gathered twice, once for counting and once for filling, so that
+ *              no buffer larger than a single adjacency list is needed.
+ */
+template<typename Gatherer>
+void BuildCSR(rmt::ThreadPool& Pool, int NNodes, Gatherer&& Gather,
+              std::vector<int>& Idxs, std::vector<int>& Adjs)
+{
+    auto Neighbors = [&](int i, std::vector<int>& Buffer)
+    {
+        Buffer.clear();
+        Gather(i, Buffer);
+        std::sort(Buffer.begin(), Buffer.end());
+        Buffer.erase(std::unique(Buffer.begin(), Buffer.end()), Buffer.end());
+    };
+
+    Idxs.assign(NNodes + 1, 0);
+    rmt::ParallelFor(Pool, 0, NNodes, [&](int, int Begin, int End)
     {
-        if (it->first != CurNode)
+        std::vector<int> Buffer;
+        for (int i = Begin; i < End; ++i)
         {
-            CurNode++;
-            m_Idxs[CurNode] = m_Adjs.size();
-            CurVert = V.row(CurNode);// m_Verts[CurNode];
+            Neighbors(i, Buffer);
+            Idxs[i + 1] = Buffer.size();
         }
+    });
+    for (int i = 0; i < NNodes; ++i)
+        Idxs[i + 1] += Idxs[i];
 
-        int ONode = it->second;
-        Eigen::Vector3d OVert = V.row(ONode);// m_Verts[ONode];
-        m_Adjs.emplace_back(ONode, (CurVert - OVert).norm());
-    }
-    m_Idxs[CurNode + 1] = m_Adjs.size();
+    Adjs.resize(Idxs[NNodes]);
+    rmt::ParallelFor(Pool, 0, NNodes, [&](int, int Begin, int End)
+    {
+        std::vector<int> Buffer;
+        for (int i = Begin; i < End; ++i)
+        {
+            Neighbors(i, Buffer);
+            std::copy(Buffer.begin(), Buffer.end(), Adjs.begin() + Idxs[i]);
+        }
+    });
 }
 
-Graph::Graph(const Eigen::MatrixXd& V, const std::vector<std::pair<int, int>>& E)
+} // namespace
+
+
+Graph::Graph(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, int NumThreads)
+    : m_Engine(rmt::QueueEngine::RadixHeap)
 {
     int nVerts = V.rows();
-    // m_Verts.resize(nVerts);
-    // for (int i = 0; i < nVerts; ++i)
-    //     m_Verts[i] = V.row(i).segment<3>(0);
+    int nTris = F.rows();
+    rmt::ThreadPool Pool(rmt::NumThreadsFor(NumThreads, nTris));
 
-    std::set<Edge> Edges;
-    int nEdges = E.size();
-    for (int i = 0; i < nEdges; ++i)
+    // Triangles incident to each vertex. A degenerate triangle is listed once for
+    // each of its occurrences, and every occurrence contributes its two opposite vertices
+    std::vector<int> VTIdxs;
+    std::vector<int> VT;
+    CountingSort(Pool, nVerts, nTris, [&](int i, auto&& Add)
     {
-        Edges.emplace(std::min(E[i].first, E[i].second), std::max(E[i].first, E[i].second));
-        Edges.emplace(std::max(E[i].first, E[i].second), std::min(E[i].first, E[i].second));
-    }
+        for (int j = 0; j < 3; ++j)
+            Add(F(i, j), i);
+    }, VTIdxs, VT);
 
-    m_Idxs.resize(nVerts + 1);
-    m_Adjs.reserve(Edges.size());
-    int CurNode = 0;
-    Eigen::Vector3d CurVert = V.row(0);// m_Verts[0];
-    for (auto it = Edges.begin(); it != Edges.end(); it++)
+    BuildCSR(Pool, nVerts, [&](int v, std::vector<int>& Buffer)
     {
-        if (it->first != CurNode)
+        for (int t = VTIdxs[v]; t < VTIdxs[v + 1]; ++t)
         {
-            CurNode++;
-            m_Idxs[CurNode] = m_Adjs.size();
-            CurVert = V.row(CurNode);// m_Verts[CurNode];
+            int f = VT[t];
+            for (int j = 0; j < 3; ++j)
+            {
+                if (F(f, j) != v)
+                    continue;
+                Buffer.emplace_back(F(f, (j + 1) % 3));
+                Buffer.emplace_back(F(f, (j + 2) % 3));
+            }
         }
+    }, m_Idxs, m_Adjs);
 
-        int ONode = it->second;
-        Eigen::Vector3d OVert = V.row(ONode);// m_Verts[ONode];
-        m_Adjs.emplace_back(ONode, (CurVert - OVert).norm());
-    }
-    m_Idxs[CurNode + 1] = m_Adjs.size();
+    // Release the incidence before allocating the weights
+    std::vector<int>().swap(VT);
+    std::vector<int>().swap(VTIdxs);
+
+    StoreVertices(V);
+    ComputeWeights(Pool);
 }
 
-Graph::Graph(const Eigen::MatrixXd& V, const std::set<std::pair<int, int>>& E)
+Graph::Graph(const Eigen::MatrixXd& V, const std::vector<std::pair<int, int>>& E, int NumThreads)
+    : m_Engine(rmt::QueueEngine::RadixHeap)
 {
     int nVerts = V.rows();
-    // m_Verts.resize(nVerts);
-    // for (int i = 0; i < nVerts; ++i)
-    //     m_Verts[i] = V.row(i).segment<3>(0);
-
-    std::set<Edge> Edges;
     int nEdges = E.size();
-    for (auto it = E.begin(); it != E.end(); it++)
+    rmt::ThreadPool Pool(rmt::NumThreadsFor(NumThreads, nEdges));
+
+    // Neighbors of each vertex, with repetitions
+    std::vector<int> VVIdxs;
+    std::vector<int> VV;
+    CountingSort(Pool, nVerts, nEdges, [&](int i, auto&& Add)
     {
-        Edges.emplace(std::min(it->first, it->second), std::max(it->first, it->second));
-        Edges.emplace(std::max(it->first, it->second), std::min(it->first, it->second));
-    }
+        Add(E[i].first, E[i].second);
+        Add(E[i].second, E[i].first);
+    }, VVIdxs, VV);
 
-    m_Idxs.resize(nVerts + 1);
-    m_Adjs.reserve(Edges.size());
-    int CurNode = 0;
-    Eigen::Vector3d CurVert = V.row(0);// m_Verts[0];
-    for (auto it = Edges.begin(); it != Edges.end(); it++)
+    BuildCSR(Pool, nVerts, [&](int v, std::vector<int>& Buffer)
     {
-        if (it->first != CurNode)
-        {
-            CurNode++;
-            m_Idxs[CurNode] = m_Adjs.size();
-            CurVert = V.row(CurNode);// m_Verts[CurNode];
-        }
+        Buffer.insert(Buffer.end(), VV.begin() + VVIdxs[v], VV.begin() + VVIdxs[v + 1]);
+    }, m_Idxs, m_Adjs);
 
-        int ONode = it->second;
-        Eigen::Vector3d OVert = V.row(ONode);// m_Verts[ONode];
-        m_Adjs.emplace_back(ONode, (CurVert - OVert).norm());
-    }
-    m_Idxs[CurNode + 1] = m_Adjs.size();
+    std::vector<int>().swap(VV);
+    std::vector<int>().swap(VVIdxs);
+
+    StoreVertices(V);
+    ComputeWeights(Pool);
 }
 
+Graph::Graph(const Eigen::MatrixXd& V, const std::set<std::pair<int, int>>& E, int NumThreads)
+    : Graph(V, std::vector<std::pair<int, int>>(E.begin(), E.end()), NumThreads)
+{ }
+
 
 Graph::Graph(const Graph& G)
 {
-    // m_Verts = G.m_Verts;
+    m_Verts = G.m_Verts;
     m_Idxs = G.m_Idxs;
     m_Adjs = G.m_Adjs;
+    m_Wgts = G.m_Wgts;
+    m_Engine = G.m_Engine;
 }
 
 Graph& Graph::operator=(const Graph& G)
 {
-    // m_Verts = G.m_Verts;
+    m_Verts = G.m_Verts;
     m_Idxs = G.m_Idxs;
     m_Adjs = G.m_Adjs;
+    m_Wgts = G.m_Wgts;
+    m_Engine = G.m_Engine;
 
     return *this;
 }
 
 Graph::Graph(Graph&& G)
 {
-    // m_Verts = std::move(G.m_Verts);
+    m_Verts = std::move(G.m_Verts);
     m_Idxs = std::move(G.m_Idxs);
     m_Adjs = std::move(G.m_Adjs);
+    m_Wgts = std::move(G.m_Wgts);
+    m_Engine = G.m_Engine;
 }
 
 Graph& Graph::operator=(Graph&& G)
 {
-    // m_Verts = std::move(G.m_Verts);
+    m_Verts = std::move(G.m_Verts);
     m_Idxs = std::move(G.m_Idxs);
     m_Adjs = std::move(G.m_Adjs);
+    m_Wgts = std::move(G.m_Wgts);
+    m_Engine = G.m_Engine;
 
     return *this;
 }
@@ -172,71 +231,471 @@ Graph& Graph::operator=(Graph&& G)
 Graph::~Graph() { }
 
 
+void Graph::ComputeWeights(rmt::ThreadPool& Pool)
+{
+    m_Wgts.resize(m_Adjs.size());
+
+    rmt::ParallelFor(Pool, 0, NumVertices(), [&](int, int NodeBegin, int NodeEnd)
+    {
+        // Edge lengths are computed in blocks: endpoints are gathered in contiguous
+        // arrays, so that the arithmetic and the square roots are vectorized by Eigen
+        constexpr int BlockSize = 256;
+        Eigen::Array<double, BlockSize, 3> Src, Dst;
+        int AdjEnd = m_Idxs[NodeEnd];
+
+        int Node = NodeBegin;
+        for (int Begin = m_Idxs[NodeBegin]; Begin < AdjEnd; Begin += BlockSize)
+        {
+            int Size = std::min(BlockSize, AdjEnd - Begin);
+            for (int k = 0; k < Size; ++k)
+            {
+                while (m_Idxs[Node + 1] <= Begin + k)
+                    Node++;
+                Src.row(k) = m_Verts[Node].cast<double>().transpose();
+                Dst.row(k) = m_Verts[m_Adjs[Begin + k]].cast<double>().transpose();
+            }
+            Eigen::Array<double, BlockSize, 1> L = (Src - Dst).square().rowwise().sum().sqrt();
+            for (int k = 0; k < Size; ++k)
+                m_Wgts[Begin + k] = (rmt::EdgeWeight)L[k];
+        }
+    });
+}
+
+void Graph::StoreVertices(const Eigen::MatrixXd& V)
+{
+    m_Verts.resize(V.rows());
+    for (int i = 0; i < V.rows(); ++i)
+        m_Verts[i] = V.row(i).head<3>().transpose().cast<rmt::NodePosition::Scalar>();
+}
+
+
 
 // int Graph::NumVertices() const { return m_Verts.size(); }
 int Graph::NumVertices() const { return m_Idxs.size() - 1; }
 int Graph::NumEdges() const { return m_Adjs.size() / 2; }
 int Graph::NumAdjacents(int i) const { return m_Idxs[i + 1] - m_Idxs[i]; }
 
-// const Eigen::Vector3d& Graph::GetVertex(int i) const { return m_Verts[i]; }
-// const std::vector<Eigen::Vector3d>& Graph::GetVertices() const { return m_Verts; }
+double Graph::MeanEdgeLength() const
+{
+    if (m_Wgts.empty())
+        return 0.0;
+    double Sum = 0.0;
+    for (rmt::EdgeWeight w : m_Wgts)
+        Sum += w;
+    return Sum / m_Wgts.size();
+}
+
+const rmt::NodePosition& Graph::GetVertex(int i) const { return m_Verts[i]; }
+const std::vector<rmt::NodePosition>& Graph::GetVertices() const { return m_Verts; }
+
+WEdge Graph::GetAdjacent(int node_i, int adj_i) const
+{
+    return { m_Adjs[m_Idxs[node_i] + adj_i], m_Wgts[m_Idxs[node_i] + adj_i] };
+}
+
+int Graph::GetNeighbor(int node_i, int adj_i) const { return m_Adjs[m_Idxs[node_i] + adj_i]; }
+double Graph::GetWeight(int node_i, int adj_i) const { return m_Wgts[m_Idxs[node_i] + adj_i]; }
+
+rmt::QueueEngine Graph::GetQueueEngine() const { return m_Engine; }
+void Graph::SetQueueEngine(rmt::QueueEngine Engine) { m_Engine = Engine; }
+
+
+rmt::DijkstraWorkspace::DijkstraWorkspace()
+{
+    m_Epoch = 0;
+}
+
+rmt::DijkstraWorkspace::DijkstraWorkspace(int NumVertices)
+    : rmt::DijkstraWorkspace()
+{
+    Reset(NumVertices);
+}
+
+rmt::DijkstraWorkspace::~DijkstraWorkspace() { }
+
+void rmt::DijkstraWorkspace::Reset(int NumVertices)
+{
+    // Only new vertices need their stamps initialized
+    if (NumVertices > (int)m_Stamps.size())
+    {
+        m_Dists.resize(NumVertices);
+        m_Parents.resize(NumVertices);
+        m_Stamps.resize(NumVertices, 0);
+        m_Settled.resize(NumVertices, 0);
+    }
+
+    // On overflow, all the stamps must be invalidated explicitly
+    m_Epoch++;
+    if (m_Epoch == 0)
+    {
+        std::fill(m_Stamps.begin(), m_Stamps.end(), 0);
+        std::fill(m_Settled.begin(), m_Settled.end(), 0);
+        m_Epoch = 1;
+    }
+
+    m_BinaryQ.Clear();
+    m_RadixQ.Clear();
+}
+
+int rmt::DijkstraWorkspace::Capacity() const { return m_Stamps.size(); }
+
+bool rmt::DijkstraWorkspace::IsReached(int i) const { return m_Stamps[i] == m_Epoch; }
+
+double rmt::DijkstraWorkspace::GetDistance(int i) const
+{
+    if (m_Stamps[i] != m_Epoch)
+        return std::numeric_limits<double>::infinity();
+    return m_Dists[i];
+}
+
+int rmt::DijkstraWorkspace::GetParent(int i) const
+{
+    if (m_Stamps[i] != m_Epoch)
+        return -1;
+    return m_Parents[i];
+}
+
+void rmt::DijkstraWorkspace::SetDistance(int i, double Dist, int Parent)
+{
+    m_Stamps[i] = m_Epoch;
+    m_Dists[i] = Dist;
+    m_Parents[i] = Parent;
+}
+
+bool rmt::DijkstraWorkspace::IsSettled(int i) const { return m_Settled[i] == m_Epoch; }
+void rmt::DijkstraWorkspace::Settle(int i) { m_Settled[i] = m_Epoch; }
+
+rmt::BinaryHeapQueue& rmt::DijkstraWorkspace::GetBinaryHeap() { return m_BinaryQ; }
+rmt::RadixHeapQueue& rmt::DijkstraWorkspace::GetRadixHeap() { return m_RadixQ; }
+
 
-const WEdge& Graph::GetAdjacent(int node_i, int adj_i) const
+
+namespace
+{
+
+/**
+ * @brief       Instantiates a queue of the given engine and invokes a traversal on it.
+ *
+ * @details     The traversal must be a callable accepting a reference to any of the
+ *              queues declared in queue.hpp. This allows writing every traversal once.
+ */
+template<typename Traversal>
+auto WithQueue(rmt::QueueEngine Engine, Traversal&& T)
 {
-    return m_Adjs[m_Idxs[node_i] + adj_i];
+    switch (Engine)
+    {
+    case rmt::QueueEngine::RadixHeap:
+    {
+        rmt::RadixHeapQueue Q;
+        return T(Q);
+    }
+    case rmt::QueueEngine::BinaryHeap:
+    default:
+    {
+        rmt::BinaryHeapQueue Q;
+        return T(Q);
+    }
+    }
 }
 
+/**
+ * @brief       Same as above, but using the persistent queues of a workspace.
+ */
+template<typename Traversal>
+auto WithQueue(rmt::QueueEngine Engine, rmt::DijkstraWorkspace& W, Traversal&& T)
+{
+    switch (Engine)
+    {
+    case rmt::QueueEngine::RadixHeap:
+        return T(W.GetRadixHeap());
+    case rmt::QueueEngine::BinaryHeap:
+    default:
+        return T(W.GetBinaryHeap());
+    }
+}
+
+/**
+ * @brief       Same as above, but with the queues of two workspaces, for the bidirectional traversals.
+ */
+template<typename Traversal>
+auto WithQueues(rmt::QueueEngine Engine, rmt::DijkstraWorkspace& W1, rmt::DijkstraWorkspace& W2, Traversal&& T)
+{
+    switch (Engine)
+    {
+    case rmt::QueueEngine::RadixHeap:
+        return T(W1.GetRadixHeap(), W2.GetRadixHeap());
+    case rmt::QueueEngine::BinaryHeap:
+    default:
+        return T(W1.GetBinaryHeap(), W2.GetBinaryHeap());
+    }
+}
+
+/**
+ * @brief       Buckets of the delta-stepping traversals, reused cyclically.
+ *
+ * @details     A node improved while relaxing a bucket is at most one bucket plus the longest
+ *              edge farther than it, so a ring of buckets as wide as the longest edge never mixes
+ *              two pending buckets. The width of the buckets is raised when the ring would have
+ *              more than MaxBuckets of them, which does not change the distances.
+ */
+class BucketRing
+{
+private:
+    static constexpr double MaxBuckets = 65536.0;
+
+    std::vector<std::vector<int>> m_Buckets;
+    double m_Delta;
+    size_t m_Pending;
+
+public:
+    BucketRing(double Delta, double MaxWeight)
+        : m_Delta(std::max(Delta, MaxWeight / MaxBuckets)), m_Pending(0)
+    {
+        m_Buckets.resize((size_t)(MaxWeight / m_Delta) + 3);
+    }
+
+    size_t BucketOf(double d) const { return (size_t)(d / m_Delta); }
+    bool Empty() const { return m_Pending == 0; }
+    std::vector<int>& operator[](size_t b) { return m_Buckets[b % m_Buckets.size()]; }
+
+    void Push(size_t b, int i)
+    {
+        (*this)[b].emplace_back(i);
+        m_Pending++;
+    }
+
+    void Clear(size_t b)
+    {
+        m_Pending -= (*this)[b].size();
+        (*this)[b].clear();
+    }
+};
+
+} // namespace
+
 
 rmt::Path Graph::DijkstraPath(int src, int dst) const
 {
-    Eigen::VectorXd Dists;
-    Dists.setConstant(NumVertices(), std::numeric_limits<double>::infinity());
+    rmt::DijkstraWorkspace W;
+    return DijkstraPath(src, dst, W);
+}
 
-    Eigen::VectorXi Parent;
-    Parent.setConstant(NumVertices(), -1);
-
-    std::priority_queue<std::pair<double, int>,
-                        std::vector<std::pair<double, int>>,
-                        std::greater<std::pair<double, int>>> Q;
-    Dists[src] = 0.0;
-    Q.emplace(0.0, src);
-    while (!Q.empty())
-    {
-        int i;
-        double wi;
-        std::tie(wi, i) = Q.top();
-        Q.pop();
-
-        if (i == dst)
-            break;
-        
-        int Degree = NumAdjacents(i);
-        for (int jj = 0; jj < Degree; ++jj)
+rmt::Path Graph::DijkstraPath(int src, int dst, rmt::DijkstraWorkspace& W) const
+{
+    W.Reset(NumVertices());
+
+    WithQueue(m_Engine, W, [&](auto& Q)
+    {
+        W.SetDistance(src, 0.0, -1);
+        Q.Push(0.0, src);
+        while (!Q.Empty())
         {
-            int j;
-            double wj;
-            std::tie(j, wj) = GetAdjacent(i, jj);
-            if (Dists[j] <= wi + wj)
+            int i;
+            double wi;
+            std::tie(wi, i) = Q.Pop();
+
+            // Skip outdated entries
+            if (wi > W.GetDistance(i))
                 continue;
-            Dists[j] = wi + wj;
-            Parent[j] = i;
-            Q.emplace(Dists[j], j);
+            if (i == dst)
+                break;
+            
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+            {
+                int j = m_Adjs[jj];
+                double wj = m_Wgts[jj];
+                if (W.GetDistance(j) <= wi + wj)
+                    continue;
+                W.SetDistance(j, wi + wj, i);
+                Q.Push(wi + wj, j);
+            }
         }
+    });
+
+    std::vector<rmt::WEdge> Path;
+    double Length = W.GetDistance(dst);
+    while (W.GetParent(dst) != -1)
+    {
+        Path.emplace_back(dst, W.GetDistance(dst) - W.GetDistance(W.GetParent(dst)));
+        dst = W.GetParent(dst);
+    }
+    Path.emplace_back(dst, W.GetDistance(dst));
+    std::reverse(Path.begin(), Path.end());
+    CUTAssert(Path[0].first == src);
+    return { Length, Path };
+}
+
+rmt::Path Graph::BidirectionalDijkstraPath(int src, int dst) const
+{
+    rmt::DijkstraWorkspace Fwd;
+    rmt::DijkstraWorkspace Bwd;
+    return BidirectionalDijkstraPath(src, dst, Fwd, Bwd);
+}
+
+rmt::Path Graph::BidirectionalDijkstraPath(int src, int dst, rmt::DijkstraWorkspace& Fwd,
+                                           rmt::DijkstraWorkspace& Bwd) const
+{
+    Fwd.Reset(NumVertices());
+    Bwd.Reset(NumVertices());
+
+    // Best path found so far, through the node Meet
+    int Meet = -1;
+    double Best = std::numeric_limits<double>::infinity();
+    if (src == dst)
+    {
+        Meet = src;
+        Best = 0.0;
     }
 
+    WithQueues(m_Engine, Fwd, Bwd, [&](auto& QF, auto& QB)
+    {
+        Fwd.SetDistance(src, 0.0, -1);
+        Bwd.SetDistance(dst, 0.0, -1);
+        QF.Push(0.0, src);
+        QB.Push(0.0, dst);
+        // Last keys extracted from the two queues, which never decrease
+        double LastF = 0.0;
+        double LastB = 0.0;
+
+        // Any path shorter than Best must be made of a node at distance at least LastF from
+        // the source and a node at distance at least LastB from the destination
+        while (!QF.Empty() && !QB.Empty() && LastF + LastB < Best)
+        {
+            // Grow the smallest ball
+            bool Forward = LastF <= LastB;
+            auto& Q = Forward ? QF : QB;
+            rmt::DijkstraWorkspace& This = Forward ? Fwd : Bwd;
+            rmt::DijkstraWorkspace& Other = Forward ? Bwd : Fwd;
+
+            int i;
+            double wi;
+            std::tie(wi, i) = Q.Pop();
+            (Forward ? LastF : LastB) = wi;
+            if (wi > This.GetDistance(i))
+                continue;
+
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+            {
+                int j = m_Adjs[jj];
+                double wj = m_Wgts[jj];
+                if (This.GetDistance(j) <= wi + wj)
+                    continue;
+                This.SetDistance(j, wi + wj, i);
+                Q.Push(wi + wj, j);
+                if (Other.IsReached(j) && wi + wj + Other.GetDistance(j) < Best)
+                {
+                    Best = wi + wj + Other.GetDistance(j);
+                    Meet = j;
+                }
+            }
+        }
+    });
+
+    CUTAssert(Meet != -1);
+
+    // Join the two halves of the path at the meeting node
     std::vector<rmt::WEdge> Path;
-    double Length = Dists[dst];
-    while (Parent[dst] != -1)
+    int i = Meet;
+    while (Fwd.GetParent(i) != -1)
     {
-        Path.emplace_back(dst, Dists[dst] - Dists[Parent[dst]]);
-        dst = Parent[dst];
+        Path.emplace_back(i, Fwd.GetDistance(i) - Fwd.GetDistance(Fwd.GetParent(i)));
+        i = Fwd.GetParent(i);
     }
-    Path.emplace_back(dst, Dists[dst]);
+    Path.emplace_back(i, 0.0);
+    std::reverse(Path.begin(), Path.end());
+    i = Meet;
+    while (Bwd.GetParent(i) != -1)
+    {
+        Path.emplace_back(Bwd.GetParent(i), Bwd.GetDistance(i) - Bwd.GetDistance(Bwd.GetParent(i)));
+        i = Bwd.GetParent(i);
+    }
+    CUTAssert(Path.front().first == src);
+    CUTAssert(Path.back().first == dst);
+    return { Fwd.GetDistance(Meet) + Bwd.GetDistance(Meet), Path };
+}
+
+
+rmt::Path Graph::AStarPath(int src, int dst) const
+{
+    rmt::DijkstraWorkspace W;
+    return AStarPath(src, dst, W);
+}
+
+rmt::Path Graph::AStarPath(int src, int dst, rmt::DijkstraWorkspace& W) const
+{
+    W.Reset(NumVertices());
+
+    // The Euclidean distance is a consistent lower bound of the geodesic distance, since the
+    // edge weights are computed from the same stored positions. It is slightly shrunk, so
+    // that it stays consistent with the rounded edge weights.
+    constexpr double Shrink = 1.0 - 1.0e-6;
+    Eigen::Vector3d Target = m_Verts[dst].cast<double>();
+    auto Heuristic = [&](int i) { return Shrink * (m_Verts[i].cast<double>() - Target).norm(); };
+
+    WithQueue(m_Engine, W, [&](auto& Q)
+    {
+        W.SetDistance(src, 0.0, -1);
+        Q.Push(Heuristic(src), src);
+        while (!Q.Empty())
+        {
+            int i;
+            double fi;
+            std::tie(fi, i) = Q.Pop();
+            // With a consistent heuristic, the first extraction of a node is final
+            if (W.IsSettled(i))
+                continue;
+            W.Settle(i);
+            if (i == dst)
+                break;
+
+            double wi = W.GetDistance(i);
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+            {
+                int j = m_Adjs[jj];
+                double wj = m_Wgts[jj];
+                if (W.IsSettled(j) || W.GetDistance(j) <= wi + wj)
+                    continue;
+                W.SetDistance(j, wi + wj, i);
+                // Keys must never decrease for the radix heap
+                Q.Push(std::max(wi + wj + Heuristic(j), fi), j);
+            }
+        }
+    });
+
+    std::vector<rmt::WEdge> Path;
+    double Length = W.GetDistance(dst);
+    while (W.GetParent(dst) != -1)
+    {
+        Path.emplace_back(dst, W.GetDistance(dst) - W.GetDistance(W.GetParent(dst)));
+        dst = W.GetParent(dst);
+    }
+    Path.emplace_back(dst, W.GetDistance(dst));
     std::reverse(Path.begin(), Path.end());
     CUTAssert(Path[0].first == src);
     return { Length, Path };
 }
 
+
+std::vector<rmt::Path> Graph::ShortestPaths(const std::vector<std::pair<int, int>>& Queries, int NumThreads) const
+{
+    std::vector<rmt::Path> Paths(Queries.size());
+    // A query may visit the whole graph, which is the work that makes a thread worth spawning
+    rmt::ThreadPool Pool(rmt::NumThreadsFor(NumThreads, (long long)Queries.size() * NumVertices()));
+    std::vector<rmt::DijkstraWorkspace> Workspaces(Pool.NumThreads());
+
+    // Queries have very different costs, so they are distributed dynamically
+    std::atomic<int> Next(0);
+    Pool.Run([&](int ThreadID)
+    {
+        rmt::DijkstraWorkspace& W = Workspaces[ThreadID];
+        for (int q = Next++; q < (int)Queries.size(); q = Next++)
+            Paths[q] = AStarPath(Queries[q].first, Queries[q].second, W);
+    });
+
+    return Paths;
+}
+
+
 Eigen::VectorXd rmt::Graph::DijkstraDistance(int src) const
 {
     Eigen::VectorXd D;
@@ -248,161 +707,569 @@ void rmt::Graph::DijkstraDistance(int src, Eigen::VectorXd& Dists) const
 {
     Dists.setConstant(NumVertices(), std::numeric_limits<double>::infinity());
 
-    std::priority_queue<std::pair<double, int>,
-                        std::vector<std::pair<double, int>>,
-                        std::greater<std::pair<double, int>>> Q;
-    Dists[src] = 0.0;
-    Q.emplace(0.0, src);
-    while (!Q.empty())
-    {
-        int i;
-        double wi;
-        std::tie(wi, i) = Q.top();
-        Q.pop();
-        
-        int Degree = NumAdjacents(i);
-        for (int jj = 0; jj < Degree; ++jj)
+    WithQueue(m_Engine, [&](auto& Q)
+    {
+        Dists[src] = 0.0;
+        Q.Push(0.0, src);
+        while (!Q.Empty())
         {
-            int j;
-            double wj;
-            std::tie(j, wj) = GetAdjacent(i, jj);
-            if (Dists[j] <= wi + wj)
+            int i;
+            double wi;
+            std::tie(wi, i) = Q.Pop();
+            if (wi > Dists[i])
                 continue;
-            Dists[j] = wi + wj;
-            Q.emplace(Dists[j], j);
+            
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+            {
+                int j = m_Adjs[jj];
+                double wj = m_Wgts[jj];
+                if (Dists[j] <= wi + wj)
+                    continue;
+                Dists[j] = wi + wj;
+                Q.Push(Dists[j], j);
+            }
         }
+    });
+}
+
+
+void rmt::Graph::DijkstraDistance(int src, Eigen::VectorXd& Dists, double Delta, int NumThreads) const
+{
+    rmt::ThreadPool Pool(rmt::NumThreadsFor(NumThreads, NumVertices()));
+    if (Pool.NumThreads() == 1)
+    {
+        DijkstraDistance(src, Dists);
+        return;
     }
+
+    int NVerts = NumVertices();
+    if (Delta <= 0.0)
+        Delta = MeanEdgeLength();
+    // Zero length edges or a broken delta leave no buckets to step through
+    if (!(Delta > 0.0) || !std::isfinite(Delta))
+    {
+        DijkstraDistance(src, Dists);
+        return;
+    }
+    double MaxWeight = m_Wgts.empty() ? 0.0 : *std::max_element(m_Wgts.begin(), m_Wgts.end());
+
+    // Distances are only decreased with a compare-and-swap loop, so they always
+    // hold the length of an actual path. The distances at convergence are the
+    // minimal fixed point of the relaxation, which is exactly what the sequential
+    // Dijkstra computes, independently of the order of the relaxations.
+    std::vector<std::atomic<double>> D(NVerts);
+    for (int i = 0; i < NVerts; ++i)
+        D[i].store(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+    // Distance of the last expansion of each node, to avoid expanding twice with the same value
+    std::vector<double> Expanded(NVerts, std::numeric_limits<double>::infinity());
+    // Stamps to remove duplicates from the frontier
+    std::vector<int> InFrontier(NVerts, -1);
+
+    BucketRing Buckets(Delta, MaxWeight);
+    std::vector<std::vector<std::pair<size_t, int>>> Requests(Pool.NumThreads());
+    D[src].store(0.0);
+    Buckets.Push(0, src);
+
+    std::vector<int> Frontier;
+    int Phase = 0;
+    for (size_t Cur = 0; !Buckets.Empty(); ++Cur)
+    {
+        while (!Buckets[Cur].empty())
+        {
+            // Extract the current bucket, removing duplicates
+            Frontier.clear();
+            for (int i : Buckets[Cur])
+            {
+                if (InFrontier[i] == Phase)
+                    continue;
+                InFrontier[i] = Phase;
+                Frontier.emplace_back(i);
+            }
+            Buckets.Clear(Cur);
+            Phase++;
+
+            // Relax all the edges of the frontier
+            rmt::ParallelFor(Pool, 0, Frontier.size(), [&](int ThreadID, int Begin, int End)
+            {
+                auto& Req = Requests[ThreadID];
+                for (int ii = Begin; ii < End; ++ii)
+                {
+                    int i = Frontier[ii];
+                    double wi = D[i].load(std::memory_order_relaxed);
+                    if (wi == Expanded[i])
+                        continue;
+                    Expanded[i] = wi;
+
+                    for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+                    {
+                        int j = m_Adjs[jj];
+                        double wj = m_Wgts[jj];
+                        double dj = D[j].load(std::memory_order_relaxed);
+                        bool Improved = false;
+                        while (wi + wj < dj)
+                        {
+                            if (D[j].compare_exchange_weak(dj, wi + wj, std::memory_order_relaxed))
+                            {
+                                Improved = true;
+                                break;
+                            }
+                        }
+                        if (Improved)
+                            Req.emplace_back(Buckets.BucketOf(wi + wj), j);
+                    }
+                }
+            });
+
+            // Move the improved nodes to their buckets
+            for (auto& Req : Requests)
+            {
+                for (const auto& r : Req)
+                {
+                    // Rounding cannot move a node to an already processed bucket
+                    Buckets.Push(std::max(r.first, Cur), r.second);
+                }
+                Req.clear();
+            }
+        }
+    }
+
+    Dists.resize(NVerts);
+    for (int i = 0; i < NVerts; ++i)
+        Dists[i] = D[i].load(std::memory_order_relaxed);
 }
 
 
-int rmt::Graph::FarthestFiltered(int src, const std::vector<int>& Tag, int Filter) const
+void rmt::Graph::MultiSourceDijkstra(const std::vector<int>& Sources, Eigen::VectorXd& Dists,
+                                     Eigen::VectorXi& Labels) const
 {
-    Eigen::VectorXd Dists;
     Dists.setConstant(NumVertices(), std::numeric_limits<double>::infinity());
+    Labels.setConstant(NumVertices(), -1);
 
-    std::priority_queue<std::pair<double, int>,
-                        std::vector<std::pair<double, int>>,
-                        std::greater<std::pair<double, int>>> Q;
-    int Farthest = src;
-    double MaxDist = 0.0;
-    Dists[src] = 0.0;
-    Q.emplace(0.0, src);
-    while (!Q.empty())
-    {
-        int i;
-        double wi;
-        std::tie(wi, i) = Q.top();
-        Q.pop();
-        if (wi > MaxDist)
+    WithQueue(m_Engine, [&](auto& Q)
+    {
+        for (int s = 0; s < (int)Sources.size(); ++s)
         {
-            MaxDist = wi;
-            Farthest = i;
+            if (Labels[Sources[s]] != -1)
+                continue;
+            Dists[Sources[s]] = 0.0;
+            Labels[Sources[s]] = s;
+            Q.Push(0.0, Sources[s]);
         }
-        
-        int Degree = NumAdjacents(i);
-        for (int jj = 0; jj < Degree; ++jj)
+        while (!Q.Empty())
         {
-            int j;
-            double wj;
-            std::tie(j, wj) = GetAdjacent(i, jj);
-            if (Tag[j] != Filter)
-                continue;
-            if (Dists[j] <= wi + wj)
+            int i;
+            double wi;
+            std::tie(wi, i) = Q.Pop();
+            if (wi > Dists[i])
                 continue;
-            Dists[j] = wi + wj;
-            Q.emplace(Dists[j], j);
+            
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+            {
+                int j = m_Adjs[jj];
+                double wj = m_Wgts[jj];
+                // Pairs (distance, label) are compared lexicographically. A node whose label
+                // improves at the same distance is queued again with the same key.
+                if (Dists[j] < wi + wj || (Dists[j] == wi + wj && Labels[j] <= Labels[i]))
+                    continue;
+                Dists[j] = wi + wj;
+                Labels[j] = Labels[i];
+                Q.Push(Dists[j], j);
+            }
         }
+    });
+}
+
+
+void rmt::Graph::MultiSourceDijkstra(const std::vector<int>& Sources, Eigen::VectorXd& Dists,
+                                     Eigen::VectorXi& Labels, double Delta, int NumThreads) const
+{
+    rmt::ThreadPool Pool(rmt::NumThreadsFor(NumThreads, NumVertices()));
+    if (Pool.NumThreads() == 1)
+    {
+        MultiSourceDijkstra(Sources, Dists, Labels);
+        return;
     }
 
-    return Farthest;
+    int NVerts = NumVertices();
+    if (Delta <= 0.0)
+        Delta = MeanEdgeLength();
+    if (!(Delta > 0.0) || !std::isfinite(Delta))
+    {
+        MultiSourceDijkstra(Sources, Dists, Labels);
+        return;
+    }
+    double MaxWeight = m_Wgts.empty() ? 0.0 : *std::max_element(m_Wgts.begin(), m_Wgts.end());
+
+    // Same as the delta-stepping of DijkstraDistance(), but the pairs (distance, label)
+    // cannot be updated with a single compare-and-swap, so each node has a spinlock.
+    // The result is the minimal fixed point of the lexicographic relaxation, which
+    // does not depend on the order of the relaxations.
+    Dists.setConstant(NVerts, std::numeric_limits<double>::infinity());
+    Labels.setConstant(NVerts, -1);
+    std::vector<std::atomic<bool>> Locks(NVerts);
+    for (int i = 0; i < NVerts; ++i)
+        Locks[i].store(false, std::memory_order_relaxed);
+    auto Lock = [&](int i) { while (Locks[i].exchange(true, std::memory_order_acquire)); };
+    auto Unlock = [&](int i) { Locks[i].store(false, std::memory_order_release); };
+
+    // Pair of the last expansion of each node, to avoid expanding twice with the same value
+    std::vector<double> ExpandedDist(NVerts, std::numeric_limits<double>::infinity());
+    std::vector<int> ExpandedLabel(NVerts, -1);
+    // Stamps to remove duplicates from the frontier
+    std::vector<int> InFrontier(NVerts, -1);
+
+    BucketRing Buckets(Delta, MaxWeight);
+    std::vector<std::vector<std::pair<size_t, int>>> Requests(Pool.NumThreads());
+    for (int s = 0; s < (int)Sources.size(); ++s)
+    {
+        if (Labels[Sources[s]] != -1)
+            continue;
+        Dists[Sources[s]] = 0.0;
+        Labels[Sources[s]] = s;
+        Buckets.Push(0, Sources[s]);
+    }
+
+    std::vector<int> Frontier;
+    int Phase = 0;
+    for (size_t Cur = 0; !Buckets.Empty(); ++Cur)
+    {
+        while (!Buckets[Cur].empty())
+        {
+            // Extract the current bucket, removing duplicates
+            Frontier.clear();
+            for (int i : Buckets[Cur])
+            {
+                if (InFrontier[i] == Phase)
+                    continue;
+                InFrontier[i] = Phase;
+                Frontier.emplace_back(i);
+            }
+            Buckets.Clear(Cur);
+            Phase++;
+
+            // Relax all the edges of the frontier
+            rmt::ParallelFor(Pool, 0, Frontier.size(), [&](int ThreadID, int Begin, int End)
+            {
+                auto& Req = Requests[ThreadID];
+                for (int ii = Begin; ii < End; ++ii)
+                {
+                    int i = Frontier[ii];
+                    Lock(i);
+                    double wi = Dists[i];
+                    int li = Labels[i];
+                    Unlock(i);
+                    if (wi == ExpandedDist[i] && li == ExpandedLabel[i])
+                        continue;
+                    ExpandedDist[i] = wi;
+                    ExpandedLabel[i] = li;
+
+                    for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+                    {
+                        int j = m_Adjs[jj];
+                        double wj = m_Wgts[jj];
+                        Lock(j);
+                        bool Improved = wi + wj < Dists[j] || (wi + wj == Dists[j] && li < Labels[j]);
+                        if (Improved)
+                        {
+                            Dists[j] = wi + wj;
+                            Labels[j] = li;
+                        }
+                        Unlock(j);
+                        if (Improved)
+                            Req.emplace_back(Buckets.BucketOf(wi + wj), j);
+                    }
+                }
+            });
+
+            // Move the improved nodes to their buckets
+            for (auto& Req : Requests)
+            {
+                for (const auto& r : Req)
+                {
+                    // Rounding cannot move a node to an already processed bucket
+                    Buckets.Push(std::max(r.first, Cur), r.second);
+                }
+                Req.clear();
+            }
+        }
+    }
 }
 
-int rmt::Graph::FarthestAtBoundary(int src, const std::vector<int>& Tag, int Region, int Neighbor) const
+
+std::vector<rmt::WEdge> rmt::Graph::DijkstraBounded(int src, double MaxDist) const
 {
-    Eigen::VectorXd Dists;
-    Dists.setConstant(NumVertices(), std::numeric_limits<double>::infinity());
+    rmt::DijkstraWorkspace W;
+    return DijkstraBounded(src, MaxDist, W);
+}
+
+std::vector<rmt::WEdge> rmt::Graph::DijkstraBounded(int src, double MaxDist, rmt::DijkstraWorkspace& W) const
+{
+    W.Reset(NumVertices());
 
-    std::priority_queue<std::pair<double, int>,
-                        std::vector<std::pair<double, int>>,
-                        std::greater<std::pair<double, int>>> Q;
-    int Farthest = src;
-    double MaxDist = 0.0;
-    Dists[src] = 0.0;
-    Q.emplace(0.0, src);
-    while (!Q.empty())
-    {
-        int i;
-        double wi;
-        std::tie(wi, i) = Q.top();
-        Q.pop();
-        
-        int Degree = NumAdjacents(i);
-        for (int jj = 0; jj < Degree; ++jj)
+    std::vector<rmt::WEdge> Reached;
+    if (MaxDist < 0.0)
+        return Reached;
+
+    WithQueue(m_Engine, W, [&](auto& Q)
+    {
+        W.SetDistance(src, 0.0, -1);
+        Q.Push(0.0, src);
+        while (!Q.Empty())
         {
-            int j;
-            double wj;
-            std::tie(j, wj) = GetAdjacent(i, jj);
-            if (Tag[j] == Neighbor && wi > MaxDist)
+            int i;
+            double wi;
+            std::tie(wi, i) = Q.Pop();
+            if (wi > W.GetDistance(i))
+                continue;
+            Reached.emplace_back(i, wi);
+            
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
             {
-                MaxDist = wi;
-                Farthest = i;
+                int j = m_Adjs[jj];
+                double wj = m_Wgts[jj];
+                // Nodes beyond the cutoff are never queued
+                if (wi + wj > MaxDist || W.GetDistance(j) <= wi + wj)
+                    continue;
+                W.SetDistance(j, wi + wj, i);
+                Q.Push(wi + wj, j);
             }
-            if (Tag[j] != Region)
-                continue;
-            if (Dists[j] <= wi + wj)
-                continue;
-            Dists[j] = wi + wj;
-            Q.emplace(Dists[j], j);
         }
-    }
+    });
 
-    return Farthest;
+    return Reached;
 }
 
 
-std::vector<int> Graph::ConnectedComponents() const
+std::vector<rmt::WEdge> rmt::Graph::DijkstraTargets(int src, const std::vector<int>& Targets, double MaxDist) const
 {
-    std::vector<int> CC;
-    CC.resize(NumVertices(), 0);
-    int CurCC = 0;
+    rmt::DijkstraWorkspace W;
+    return DijkstraTargets(src, Targets, MaxDist, W);
+}
+
+std::vector<rmt::WEdge> rmt::Graph::DijkstraTargets(int src, const std::vector<int>& Targets, double MaxDist,
+                                                    rmt::DijkstraWorkspace& W) const
+{
+    W.Reset(NumVertices());
 
-    Eigen::VectorXi Visited;
-    Visited.resize(NumVertices());
-    Visited.setZero();
+    // Targets are looked up with a binary search, so repeated targets are counted once
+    std::vector<int> Sorted(Targets.begin(), Targets.end());
+    std::sort(Sorted.begin(), Sorted.end());
+    Sorted.erase(std::unique(Sorted.begin(), Sorted.end()), Sorted.end());
+    int Remaining = Sorted.size();
 
-    while (Visited.sum() < NumVertices())
+    std::vector<rmt::WEdge> Reached;
+    if (Remaining == 0 || MaxDist < 0.0)
+        return Reached;
+    Reached.reserve(Remaining);
+
+    WithQueue(m_Engine, W, [&](auto& Q)
     {
-        int Root = 0;
-        for (int i = 0; i < NumVertices(); ++i)
+        W.SetDistance(src, 0.0, -1);
+        Q.Push(0.0, src);
+        while (!Q.Empty())
         {
-            if (Visited[i] == 0)
+            int i;
+            double wi;
+            std::tie(wi, i) = Q.Pop();
+            if (wi > W.GetDistance(i))
+                continue;
+            if (std::binary_search(Sorted.begin(), Sorted.end(), i))
             {
-                Root = i;
-                break;
+                Reached.emplace_back(i, wi);
+                if (--Remaining == 0)
+                    break;
+            }
+            
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+            {
+                int j = m_Adjs[jj];
+                double wj = m_Wgts[jj];
+                if (wi + wj > MaxDist || W.GetDistance(j) <= wi + wj)
+                    continue;
+                W.SetDistance(j, wi + wj, i);
+                Q.Push(wi + wj, j);
             }
         }
+    });
+
+    return Reached;
+}
 
-        std::queue<int> Q;
-        Q.emplace(Root);
-        while (!Q.empty())
+
+int rmt::Graph::FarthestFiltered(int src, const std::vector<int>& Tag, int Filter) const
+{
+    rmt::DijkstraWorkspace W;
+    return FarthestFiltered(src, Tag, Filter, W);
+}
+
+int rmt::Graph::FarthestFiltered(int src, const std::vector<int>& Tag, int Filter,
+                                 rmt::DijkstraWorkspace& W) const
+{
+    W.Reset(NumVertices());
+
+    return WithQueue(m_Engine, W, [&](auto& Q)
+    {
+        int Farthest = src;
+        double MaxDist = 0.0;
+        W.SetDistance(src, 0.0, -1);
+        Q.Push(0.0, src);
+        while (!Q.Empty())
         {
-            int N = Q.front();
-            Q.pop();
+            int i;
+            double wi;
+            std::tie(wi, i) = Q.Pop();
+            // Outdated entries overestimate the distance, they must not be considered
+            if (wi > W.GetDistance(i))
+                continue;
+            if (wi > MaxDist)
+            {
+                MaxDist = wi;
+                Farthest = i;
+            }
             
-            if (Visited[N] != 0)
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+            {
+                int j = m_Adjs[jj];
+                double wj = m_Wgts[jj];
+                if (Tag[j] != Filter)
+                    continue;
+                if (W.GetDistance(j) <= wi + wj)
+                    continue;
+                W.SetDistance(j, wi + wj, i);
+                Q.Push(wi + wj, j);
+            }
+        }
+
+        return Farthest;
+    });
+}
+
+int rmt::Graph::FarthestAtBoundary(int src, const std::vector<int>& Tag, int Region, int Neighbor) const
+{
+    rmt::DijkstraWorkspace W;
+    return FarthestAtBoundary(src, Tag, Region, Neighbor, W);
+}
+
+int rmt::Graph::FarthestAtBoundary(int src, const std::vector<int>& Tag, int Region, int Neighbor,
+                                   rmt::DijkstraWorkspace& W) const
+{
+    W.Reset(NumVertices());
+
+    return WithQueue(m_Engine, W, [&](auto& Q)
+    {
+        int Farthest = src;
+        double MaxDist = 0.0;
+        W.SetDistance(src, 0.0, -1);
+        Q.Push(0.0, src);
+        while (!Q.Empty())
+        {
+            int i;
+            double wi;
+            std::tie(wi, i) = Q.Pop();
+            if (wi > W.GetDistance(i))
                 continue;
+            
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
+            {
+                int j = m_Adjs[jj];
+                double wj = m_Wgts[jj];
+                if (Tag[j] == Neighbor && wi > MaxDist)
+                {
+                    MaxDist = wi;
+                    Farthest = i;
+                }
+                if (Tag[j] != Region)
+                    continue;
+                if (W.GetDistance(j) <= wi + wj)
+                    continue;
+                W.SetDistance(j, wi + wj, i);
+                Q.Push(wi + wj, j);
+            }
+        }
 
-            CC[N] = CurCC;
-            Visited[N] = 1;
-            int DegN = NumAdjacents(N);
-            for (int jj = 0; jj < DegN; ++jj)
+        return Farthest;
+    });
+}
+
+
+std::vector<int> Graph::ConnectedComponents() const
+{
+    std::vector<int> Sizes;
+    return ConnectedComponents(Sizes);
+}
+
+std::vector<int> Graph::ConnectedComponents(std::vector<int>& Sizes, int NumThreads) const
+{
+    int NVerts = NumVertices();
+    rmt::ThreadPool Pool(rmt::NumThreadsFor(NumThreads, NVerts));
+
+    // Lock-free union-find. Roots are always linked under the smaller one, so the
+    // root of each component is its vertex with the smallest index.
+    std::vector<std::atomic<int>> Parent(NVerts);
+    for (int i = 0; i < NVerts; ++i)
+        Parent[i].store(i, std::memory_order_relaxed);
+
+    auto Find = [&](int i)
+    {
+        int p = Parent[i].load(std::memory_order_relaxed);
+        while (p != i)
+        {
+            // Path halving. A failed exchange only means that another thread compressed first.
+            int gp = Parent[p].load(std::memory_order_relaxed);
+            if (gp != p)
+                Parent[i].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            i = p;
+            p = Parent[i].load(std::memory_order_relaxed);
+        }
+        return i;
+    };
+
+    rmt::ParallelFor(Pool, 0, NVerts, [&](int, int Begin, int End)
+    {
+        for (int i = Begin; i < End; ++i)
+        {
+            for (int jj = m_Idxs[i]; jj < m_Idxs[i + 1]; ++jj)
             {
-                int j = GetAdjacent(N, jj).first;
-                Q.emplace(j);
+                // Each undirected edge is merged once
+                if (m_Adjs[jj] < i)
+                    continue;
+                int a = Find(i);
+                int b = Find(m_Adjs[jj]);
+                while (a != b)
+                {
+                    if (a < b)
+                        std::swap(a, b);
+                    // Link a under b only if it is still a root
+                    int Expected = a;
+                    if (Parent[a].compare_exchange_strong(Expected, b, std::memory_order_relaxed))
+                        break;
+                    a = Find(a);
+                    b = Find(b);
+                }
             }
         }
+    });
 
-        CurCC += 1;
+    std::vector<int> CC(NVerts);
+    rmt::ParallelFor(Pool, 0, NVerts, [&](int, int Begin, int End)
+    {
+        for (int i = Begin; i < End; ++i)
+            CC[i] = Find(i);
+    });
+
+    // Components are numbered by their smallest vertex, as in a sequential visit.
+    // A root precedes all the vertices of its component, so it is always labelled first.
+    Sizes.clear();
+    for (int i = 0; i < NVerts; ++i)
+    {
+        if (CC[i] == i)
+        {
+            CC[i] = Sizes.size();
+            Sizes.emplace_back(0);
+        }
+        else
+            CC[i] = CC[CC[i]];
+        Sizes[CC[i]]++;
     }
 
     return CC;
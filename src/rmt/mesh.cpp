@@ -103,8 +103,9 @@ const Eigen::VectorXi& rmt::Mesh::GetBoundaryVertices() const
 void rmt::Mesh::ComputeEdgesAndBoundaries()
 {
     // Compute all the edges and their number
-    std::unordered_map<std::pair<int, int>, std::pair<int, int>, rmt::PairHash<int>> m_Ecount;
-    m_Ecount.reserve(2 * NumTriangles());
+    // The index of an edge is its position in insertion order
+    rmt::FlatHashMap<std::uint64_t, int> m_Ecount;
+    m_Ecount.Reserve(2 * NumTriangles());
     for (int i = 0; i < m_F.rows(); ++i)
     {
         for (int j = 0; j < 3; ++j)
@@ -112,31 +113,29 @@ void rmt::Mesh::ComputeEdgesAndBoundaries()
             int j1 = j + 1;
             if (j1 > 2)
                 j1 = 0;
-            std::pair<int, int> e{m_F(i, j), m_F(i, j1)};
-            if (e.first > e.second)
-                std::swap(e.first, e.second);
-            if (m_Ecount.find(e) == m_Ecount.end())
-            {
-                std::pair<int, int> cnt{m_Ecount.size(), 0};
-                m_Ecount.emplace(e, cnt);
-            }
-            m_Ecount[e].second += 1;
+            int e0 = m_F(i, j);
+            int e1 = m_F(i, j1);
+            if (e0 > e1)
+                std::swap(e0, e1);
+            *m_Ecount.Insert(rmt::PackPair(e0, e1), 0).first += 1;
         }
     }
 
-    m_E.resize(m_Ecount.size(), 2);
-    m_BE.setZero(m_Ecount.size());
+    m_E.resize(m_Ecount.Size(), 2);
+    m_BE.setZero(m_Ecount.Size());
     m_BV.setZero(NumVertices());
-    for (auto ec : m_Ecount)
+    int EIdx = 0;
+    for (const auto& ec : m_Ecount)
     {
-        m_E(ec.second.first, 0) = ec.first.first;
-        m_E(ec.second.first, 1) = ec.first.second;
-        if (ec.second.second == 1)
+        m_E(EIdx, 0) = (int)(ec.first >> 32);
+        m_E(EIdx, 1) = (int)(std::uint32_t)ec.first;
+        if (ec.second == 1)
         {
-            m_BE[ec.second.first] = 1;
-            m_BV[m_E(ec.second.first, 0)] = 1;
-            m_BV[m_E(ec.second.first, 1)] = 1;
+            m_BE[EIdx] = 1;
+            m_BV[m_E(EIdx, 0)] = 1;
+            m_BV[m_E(EIdx, 1)] = 1;
         }
+        EIdx++;
     }
 }
 
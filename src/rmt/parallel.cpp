@@ -0,0 +1,103 @@
+/**
+ * @file        parallel.cpp
+ *
+ * @brief       Implements rmt::ThreadPool.
+ *
+ * @author      agent (agent@local)
+ *
+ * @date        2026-10-16
+ */
+#include <rmt/parallel.hpp>
+
+
+int rmt::DefaultNumThreads()
+{
+    return std::max((int)std::thread::hardware_concurrency(), 1);
+}
+
+int rmt::NumThreadsFor(int NumThreads, long long NumItems, long long MinItemsPerThread)
+{
+    if (NumThreads <= 0)
+        NumThreads = rmt::DefaultNumThreads();
+    long long MaxThreads = NumItems / std::max(MinItemsPerThread, 1LL);
+    return (int)std::max(std::min((long long)NumThreads, MaxThreads), 1LL);
+}
+
+
+rmt::ThreadPool::ThreadPool(int NumThreads)
+{
+    if (NumThreads <= 0)
+        NumThreads = rmt::DefaultNumThreads();
+
+    m_Generation = 0;
+    m_Pending = 0;
+    m_Stop = false;
+
+    // The calling thread acts as thread zero
+    m_Workers.reserve(NumThreads - 1);
+    for (int i = 1; i < NumThreads; ++i)
+        m_Workers.emplace_back(&rmt::ThreadPool::WorkerLoop, this, i);
+}
+
+rmt::ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_StartCV.notify_all();
+    for (auto& W : m_Workers)
+        W.join();
+}
+
+
+int rmt::ThreadPool::NumThreads() const { return m_Workers.size() + 1; }
+
+
+void rmt::ThreadPool::WorkerLoop(int ThreadID)
+{
+    size_t LastGeneration = 0;
+    while (true)
+    {
+        std::function<void(int)>* Task;
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            m_StartCV.wait(Lock, [&]() { return m_Stop || m_Generation != LastGeneration; });
+            if (m_Stop)
+                return;
+            LastGeneration = m_Generation;
+            Task = &m_Task;
+        }
+
+        (*Task)(ThreadID);
+
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            m_Pending--;
+            if (m_Pending == 0)
+                m_DoneCV.notify_one();
+        }
+    }
+}
+
+void rmt::ThreadPool::Run(const std::function<void(int)>& Task)
+{
+    if (m_Workers.empty())
+    {
+        Task(0);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_Task = Task;
+        m_Pending = m_Workers.size();
+        m_Generation++;
+    }
+    m_StartCV.notify_all();
+
+    Task(0);
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    m_DoneCV.wait(Lock, [&]() { return m_Pending == 0; });
+}
@@ -0,0 +1,218 @@
+/**
+ * @file        queue.cpp
+ *
+ * @brief       Implements the priority queues declared in queue.hpp.
+ *
+ * @author      agent (agent@local)
+ *
+ * @date        2026-10-16
+ */
+#include <rmt/queue.hpp>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+rmt::BinaryHeapQueue::BinaryHeapQueue() { }
+rmt::BinaryHeapQueue::~BinaryHeapQueue() { }
+
+bool rmt::BinaryHeapQueue::Empty() const { return m_Heap.empty(); }
+size_t rmt::BinaryHeapQueue::Size() const { return m_Heap.size(); }
+void rmt::BinaryHeapQueue::Clear() { m_Heap.clear(); }
+void rmt::BinaryHeapQueue::Reserve(size_t Capacity) { m_Heap.reserve(Capacity); }
+
+void rmt::BinaryHeapQueue::Push(double Key, int Node)
+{
+    m_Heap.emplace_back(Key, Node);
+    std::push_heap(m_Heap.begin(), m_Heap.end(), std::greater<std::pair<double, int>>());
+}
+
+std::pair<double, int> rmt::BinaryHeapQueue::Pop()
+{
+    std::pop_heap(m_Heap.begin(), m_Heap.end(), std::greater<std::pair<double, int>>());
+    std::pair<double, int> Top = m_Heap.back();
+    m_Heap.pop_back();
+    return Top;
+}
+
+
+
+rmt::RadixHeapQueue::RadixHeapQueue()
+{
+    m_Last = 0;
+    m_Size = 0;
+}
+
+rmt::RadixHeapQueue::~RadixHeapQueue() { }
+
+uint64_t rmt::RadixHeapQueue::ToBits(double Key)
+{
+    // Also maps -0.0 to the bit pattern of +0.0
+    if (Key <= 0.0)
+        return 0;
+    uint64_t Bits;
+    std::memcpy(&Bits, &Key, sizeof(double));
+    return Bits;
+}
+
+double rmt::RadixHeapQueue::FromBits(uint64_t Bits)
+{
+    double Key;
+    std::memcpy(&Key, &Bits, sizeof(double));
+    return Key;
+}
+
+int rmt::RadixHeapQueue::BucketIndex(uint64_t Bits) const
+{
+    uint64_t Diff = Bits ^ m_Last;
+    if (Diff == 0)
+        return 0;
+#if defined(_MSC_VER)
+    unsigned long MSB;
+    _BitScanReverse64(&MSB, Diff);
+    return (int)MSB + 1;
+#else
+    return 64 - __builtin_clzll(Diff);
+#endif
+}
+
+bool rmt::RadixHeapQueue::Empty() const { return m_Size == 0; }
+size_t rmt::RadixHeapQueue::Size() const { return m_Size; }
+
+void rmt::RadixHeapQueue::Clear()
+{
+    // Buckets keep their capacity, so a cleared queue does not allocate again
+    for (int i = 0; i < 65; ++i)
+        m_Buckets[i].clear();
+    m_Last = 0;
+    m_Size = 0;
+}
+
+void rmt::RadixHeapQueue::Reserve(size_t Capacity)
+{
+    // Most of the elements are redistributed through the lowest buckets
+    m_Buckets[0].reserve(std::min<size_t>(Capacity, 64));
+}
+
+void rmt::RadixHeapQueue::Push(double Key, int Node)
+{
+    uint64_t Bits = ToBits(Key);
+    m_Buckets[BucketIndex(Bits)].emplace_back(Bits, Node);
+    m_Size++;
+}
+
+std::pair<double, int> rmt::RadixHeapQueue::Pop()
+{
+    if (m_Buckets[0].empty())
+    {
+        // Find the first non-empty bucket and its minimum key
+        int i = 1;
+        while (m_Buckets[i].empty())
+            ++i;
+        uint64_t Min = m_Buckets[i][0].first;
+        for (const auto& e : m_Buckets[i])
+            Min = std::min(Min, e.first);
+
+        // Redistribute the bucket with respect to the new minimum.
+        // Every element lands in a bucket strictly lower than i.
+        m_Last = Min;
+        for (const auto& e : m_Buckets[i])
+            m_Buckets[BucketIndex(e.first)].emplace_back(e);
+        m_Buckets[i].clear();
+    }
+
+    std::pair<uint64_t, int> Top = m_Buckets[0].back();
+    m_Buckets[0].pop_back();
+    m_Size--;
+    return { FromBits(Top.first), Top.second };
+}
+
+
+
+rmt::IndexedMaxHeap::IndexedMaxHeap() { }
+rmt::IndexedMaxHeap::~IndexedMaxHeap() { }
+
+bool rmt::IndexedMaxHeap::Precedes(const std::pair<double, int>& A, const std::pair<double, int>& B)
+{
+    return A.first > B.first || (A.first == B.first && A.second < B.second);
+}
+
+void rmt::IndexedMaxHeap::SiftUp(int i)
+{
+    std::pair<double, int> Cur = m_Heap[i];
+    while (i > 0)
+    {
+        int Parent = (i - 1) / 4;
+        if (!Precedes(Cur, m_Heap[Parent]))
+            break;
+        m_Heap[i] = m_Heap[Parent];
+        m_Pos[m_Heap[i].second] = i;
+        i = Parent;
+    }
+    m_Heap[i] = Cur;
+    m_Pos[Cur.second] = i;
+}
+
+void rmt::IndexedMaxHeap::SiftDown(int i)
+{
+    int N = m_Heap.size();
+    std::pair<double, int> Cur = m_Heap[i];
+    while (true)
+    {
+        int First = 4 * i + 1;
+        if (First >= N)
+            break;
+        int Last = std::min(First + 4, N);
+        int Best = First;
+        for (int c = First + 1; c < Last; ++c)
+        {
+            if (Precedes(m_Heap[c], m_Heap[Best]))
+                Best = c;
+        }
+        if (!Precedes(m_Heap[Best], Cur))
+            break;
+        m_Heap[i] = m_Heap[Best];
+        m_Pos[m_Heap[i].second] = i;
+        i = Best;
+    }
+    m_Heap[i] = Cur;
+    m_Pos[Cur.second] = i;
+}
+
+void rmt::IndexedMaxHeap::Build(const double* Keys, int NumNodes)
+{
+    m_Heap.resize(NumNodes);
+    m_Pos.resize(NumNodes);
+    for (int i = 0; i < NumNodes; ++i)
+    {
+        m_Heap[i] = { Keys[i], i };
+        m_Pos[i] = i;
+    }
+    for (int i = (NumNodes - 2) / 4; i >= 0; --i)
+        SiftDown(i);
+}
+
+bool rmt::IndexedMaxHeap::Empty() const { return m_Heap.empty(); }
+size_t rmt::IndexedMaxHeap::Size() const { return m_Heap.size(); }
+std::pair<double, int> rmt::IndexedMaxHeap::Top() const { return m_Heap[0]; }
+double rmt::IndexedMaxHeap::GetKey(int Node) const { return m_Heap[m_Pos[Node]].first; }
+
+void rmt::IndexedMaxHeap::Push(double Key, int Node)
+{
+    if (Node >= (int)m_Pos.size())
+        m_Pos.resize(Node + 1, -1);
+    m_Heap.emplace_back(Key, Node);
+    SiftUp(m_Heap.size() - 1);
+}
+
+void rmt::IndexedMaxHeap::DecreaseKey(int Node, double Key)
+{
+    int i = m_Pos[Node];
+    if (Key >= m_Heap[i].first)
+        return;
+    m_Heap[i].first = Key;
+    SiftDown(i);
+}
@@ -38,14 +38,6 @@ struct MyPairHash
     }
 };
 
-struct MyTriHash
-{
-    std::size_t operator()(const Tri& t) const noexcept
-    {
-        return std::hash<int>{}(std::get<0>(t)) ^ ((std::get<1>(t) ^ (std::get<2>(t) << 1)) << 1);
-    }
-};
-
 void rmt::MeshFromVoronoi(const Eigen::MatrixXd& VOld,
                           const Eigen::MatrixXi& FOld,
                           rmt::VoronoiPartitioning& Parts,
@@ -63,8 +55,9 @@ void rmt::MeshFromVoronoi(const Eigen::MatrixXd& VOld,
         V.row(i) = VOld.row(Samples[i]);
 
     // Iterate over original faces and compute triangles incident on three partitions
-    std::unordered_set<Tri, MyTriHash> Tris;
-    Tris.reserve(3 * nSamples);
+    // The triangles are kept in the order of their first face
+    rmt::FlatHashMap<rmt::PackedTriple, bool> Tris;
+    Tris.Reserve(2 * nSamples);
     for (int i = 0; i < FOld.rows(); ++i)
     {
         if (Partition[FOld(i, 0)] == Partition[FOld(i, 1)])
@@ -80,14 +73,14 @@ void rmt::MeshFromVoronoi(const Eigen::MatrixXd& VOld,
         else if (std::get<2>(t) < std::get<0>(t) && std::get<2>(t) < std::get<1>(t))
             t = Tri(std::get<2>(t), std::get<0>(t), std::get<1>(t));
 
-        Tris.insert(t);
+        Tris.Insert(rmt::PackTriple(std::get<0>(t), std::get<1>(t), std::get<2>(t)), true);
     }
 
     // Create the new faces
-    F.resize(Tris.size(), 3);
+    F.resize(Tris.Size(), 3);
     int i = 0;
-    for (const Tri& t : Tris)
-        F.row(i++) = Eigen::RowVector3i(std::get<0>(t), std::get<1>(t), std::get<2>(t));
+    for (const auto& t : Tris)
+        F.row(i++) = Eigen::RowVector3i((int)(t.first.AB >> 32), (int)(std::uint32_t)t.first.AB, (int)t.first.C);
 
 
     
@@ -20,7 +20,6 @@ rmt::SurfaceRegion::SurfaceRegion(int pi, int pj, int pk)
     // m_NVerts = 0;
     // m_NEdges = 0;
     // m_NFaces = 0;
-    m_chi = 0;
 
     rmt::RegionDictionary::OrderIndices(pi, pj, pk);
     m_Samples = { pi, pj, pk };
@@ -31,7 +30,6 @@ rmt::SurfaceRegion::SurfaceRegion(const rmt::SurfaceRegion& SR)
     // m_NVerts = SR.m_NVerts;
     // m_NEdges = SR.m_NEdges;
     // m_NFaces = SR.m_NFaces;
-    m_chi = SR.m_chi;
     m_Samples = SR.m_Samples;
 }
 
@@ -40,7 +38,6 @@ rmt::SurfaceRegion& rmt::SurfaceRegion::operator=(const rmt::SurfaceRegion& SR)
     // m_NVerts = SR.m_NVerts;
     // m_NEdges = SR.m_NEdges;
     // m_NFaces = SR.m_NFaces;
-    m_chi = SR.m_chi;
     m_Samples = SR.m_Samples;
 
     return *this;
@@ -54,22 +51,6 @@ std::tuple<int, int, int> rmt::SurfaceRegion::GetSamples() const { return m_Samp
 // int rmt::SurfaceRegion::NumVertices() const { return m_NVerts; }
 // int rmt::SurfaceRegion::NumFaces() const    { return m_NFaces; }
 // int rmt::SurfaceRegion::NumEdges() const    { return m_NEdges; }
-int rmt::SurfaceRegion::EulerCharacteristic() const
-{
-    // return NumVertices() + NumFaces() - NumEdges();
-    return m_chi;
-}
-
-// void rmt::SurfaceRegion::AddFace()          { m_NFaces += 1; }
-// void rmt::SurfaceRegion::AddVertex()        { m_NVerts += 1; }
-// void rmt::SurfaceRegion::AddEdge()          { m_NEdges += 1; }
-// void rmt::SurfaceRegion::AddBoundaryEdge()  { m_NEdges += 1; m_NVerts += 1; }
-// void rmt::SurfaceRegion::AddBoundaryFace()  { m_NFaces += 1; m_NVerts += 1; m_NEdges += 2; }
-void rmt::SurfaceRegion::AddFace()          { m_chi += 1; }
-void rmt::SurfaceRegion::AddVertex()        { m_chi += 1; }
-void rmt::SurfaceRegion::AddEdge()          { m_chi -= 1; }
-// void rmt::SurfaceRegion::AddBoundaryEdge()  { }
-// void rmt::SurfaceRegion::AddBoundaryFace()  { }
 
 
 bool rmt::operator==(const rmt::SurfaceRegion& SR1, const rmt::SurfaceRegion& SR2)
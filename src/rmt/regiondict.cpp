@@ -12,6 +12,9 @@
 #include <rmt/region.hpp>
 #include <cut/cut.hpp>
 #include <iostream>
+#include <algorithm>
+#include <utility>
+
 
 rmt::RegionDictionary::RegionDictionary() { }
 
@@ -25,26 +28,29 @@ rmt::RegionDictionary::~RegionDictionary() { }
 
 void rmt::RegionDictionary::Clear()
 {
-    size_t NumSamples = m_VMap.size();
+    size_t NumSamples = m_VIdx.size();
     Clear(NumSamples);
 }
 
 void rmt::RegionDictionary::Clear(size_t NumSamples)
 {
-    m_VMap.clear();
+    Clear(NumSamples, 3 * NumSamples);
+}
+
+void rmt::RegionDictionary::Clear(size_t NumSamples, size_t NumRegions)
+{
+    // Only the samples of the current regions have a count
+    for (int p : m_VSamples)
+        m_VIdx[p] = -1;
+    m_VSamples.clear();
     m_Regions.clear();
-    m_RegSamples.clear();
-
-    m_ESet.clear();
-    m_ESet.reserve(3 * NumSamples);
-    m_TSet.clear();
-    m_TSet.reserve(3 * NumSamples);
-
-    m_Regions.reserve(3 * NumSamples);
-    m_RegSamples.reserve(3 * NumSamples);
-    m_VMap.resize(NumSamples);
-    for (auto& RegList : m_VMap)
-        RegList.reserve(6);
+
+    m_RegSamples.Clear(NumRegions);
+    m_EIdx.Clear(NumRegions);
+    m_TIdx.Clear(NumRegions);
+
+    m_Regions.reserve(NumRegions);
+    m_VIdx.resize(NumSamples, -1);
 }
 
 
@@ -76,23 +82,16 @@ void rmt::RegionDictionary::AddRegion(int pi, int pj, int pk)
         return;
 
     OrderIndices(pi, pj, pk);
-    if (HasRegion(pi, pj, pk))
+    if (!m_RegSamples.Insert(rmt::PackTriple(pi, pj, pk), true).second)
         return;
 
-
     m_Regions.emplace_back(pi, pj, pk);
-    auto& Reg = m_Regions[(int)m_Regions.size() - 1];
-    m_RegSamples.emplace(Reg.GetSamples());
 
-    m_VMap[pi].emplace_back((int)m_Regions.size() - 1);
-    m_VMap[pj].emplace_back((int)m_Regions.size() - 1);
-    m_VMap[pk].emplace_back((int)m_Regions.size() - 1);
+    m_EIdx.Insert(rmt::PackPair(pi, pj), (int)m_EIdx.Size());
+    m_EIdx.Insert(rmt::PackPair(pj, pk), (int)m_EIdx.Size());
+    m_EIdx.Insert(rmt::PackPair(pi, pk), (int)m_EIdx.Size());
 
-    m_ESet.emplace(pi, pj);
-    m_ESet.emplace(pj, pk);
-    m_ESet.emplace(pi, pk);
-
-    m_TSet.emplace(pi, pj, pk);
+    m_TIdx.Insert(rmt::PackTriple(pi, pj, pk), (int)m_TIdx.Size());
 }
 
 void rmt::RegionDictionary::AddRegion(int pi, int pj)
@@ -101,29 +100,20 @@ void rmt::RegionDictionary::AddRegion(int pi, int pj)
         return;
 
     OrderIndices(pi, pj);
-    if (HasRegion(pi, pj))
+    if (!m_RegSamples.Insert(rmt::PackTriple(pi, pj, std::numeric_limits<int>::max()), true).second)
         return;
 
     m_Regions.emplace_back(pi, pj);
-    auto& Reg = m_Regions[(int)m_Regions.size() - 1];
-    m_RegSamples.emplace(Reg.GetSamples());
-
-    m_VMap[pi].emplace_back((int)m_Regions.size() - 1);
-    m_VMap[pj].emplace_back((int)m_Regions.size() - 1);
 
-    m_ESet.emplace(pi, pj);
+    m_EIdx.Insert(rmt::PackPair(pi, pj), (int)m_EIdx.Size());
 }
 
 void rmt::RegionDictionary::AddRegion(int pi)
 {
-    if (HasRegion(pi))
+    if (!m_RegSamples.Insert(rmt::PackTriple(pi, std::numeric_limits<int>::max() - 1, std::numeric_limits<int>::max()), true).second)
         return;
 
     m_Regions.emplace_back(pi);
-    auto& Reg = m_Regions[(int)m_Regions.size() - 1];
-    m_RegSamples.emplace(Reg.GetSamples());
-    
-    m_VMap[pi].emplace_back((int)m_Regions.size() - 1);
     
     // m_TMap.emplace(Reg.GetSamples(), (int)m_Regions.size() - 1);
 }
@@ -131,7 +121,7 @@ void rmt::RegionDictionary::AddRegion(int pi)
 bool rmt::RegionDictionary::HasRegion(int pi, int pj, int pk) const
 {
     OrderIndices(pi, pj, pk);
-    return m_RegSamples.find({ pi, pj, pk }) != m_RegSamples.end();
+    return m_RegSamples.Contains(rmt::PackTriple(pi, pj, pk));
 }
 
 bool rmt::RegionDictionary::HasRegion(int pi, int pj) const
@@ -146,11 +136,28 @@ bool rmt::RegionDictionary::HasRegion(int pi) const
 
 
 
-void rmt::RegionDictionary::AddVertex(int pi)
+void rmt::RegionDictionary::CountSample(int pi, int Delta, Counts& C)
+{
+    int Idx = m_VIdx[pi];
+    if (Idx != -1)
+        C.V[Idx] += Delta;
+}
+
+void rmt::RegionDictionary::CountCouple(int pi, int pj, int Delta, Counts& C)
+{
+    // A couple can only be in a region if both its samples are
+    if (m_VIdx[pi] == -1 || m_VIdx[pj] == -1)
+        return;
+    const int* Idx = m_EIdx.Find(rmt::PackPair(pi, pj));
+    if (Idx != nullptr)
+        C.E[*Idx] += Delta;
+}
+
+
+void rmt::RegionDictionary::AddVertex(int pi, int ThreadID)
 {
     // Adding a primal vertex means adding a face
-    for (int RID : m_VMap[pi])
-        m_Regions[RID].AddFace();
+    CountSample(pi, +1, m_Counts[ThreadID]);
 }
 
 // void rmt::RegionDictionary::AddBoundaryVertex(int pi)
@@ -160,22 +167,23 @@ void rmt::RegionDictionary::AddVertex(int pi)
 //         m_Regions[RID].AddBoundaryFace();
 // }
 
-void rmt::RegionDictionary::AddEdge(int pi, int pj)
+void rmt::RegionDictionary::AddEdge(int pi, int pj, int ThreadID)
 {
+    Counts& C = m_Counts[ThreadID];
+
     // Adding a primal edge means adding a dual edge
-    // If they are the same sample, we add an edge to all the regions that contain that sample
+    // If they are the same sample, we count an edge for that sample only
     if (pi == pj)
     {
-        for (int RID : m_VMap[pi])
-            m_Regions[RID].AddEdge();
+        CountSample(pi, -1, C);
         return;
     }
 
-    // Otherwise add an edge to the regions that contain at leas one of the samples
+    // Otherwise we count an edge for both the samples and for their couple
     OrderIndices(pi, pj);
-    std::pair<int, int> e{pi, pj};
-    for (int i : m_EMap[e])
-        m_Regions[i].AddEdge();
+    CountSample(pi, -1, C);
+    CountSample(pj, -1, C);
+    CountCouple(pi, pj, -1, C);
 }
 
 // void rmt::RegionDictionary::AddBoundaryEdge(int pi, int pj)
@@ -196,35 +204,44 @@ void rmt::RegionDictionary::AddEdge(int pi, int pj)
 //         m_Regions[i].AddBoundaryEdge();
 // }
 
-void rmt::RegionDictionary::AddTriangle(int pi, int pj, int pk)
+void rmt::RegionDictionary::AddTriangle(int pi, int pj, int pk, int ThreadID)
 {
+    Counts& C = m_Counts[ThreadID];
+
     // Adding a primal triangle means adding a dual vertex
-    // If all vertices belongs to the same partition, we add a vertex to all
-    // the regions containing that partition
+    // If all vertices belongs to the same partition, we count a vertex
+    // for that partition only
     if (pi == pj && pj == pk)
     {
-        for (int RID : m_VMap[pi])
-            m_Regions[RID].AddVertex();
+        CountSample(pi, +1, C);
         return;
     }
 
     // Ease the identification of different partitions
     OrderIndices(pi, pj, pk);
-    // If two vertices belongs to the same partition, we add a vertex to all
-    // the regions containing at least one between that partition and the other
+    // If two vertices belongs to the same partition, we count a vertex for
+    // the two partitions and for their couple
     if (pi == pj || pj == pk)
     {
-        std::pair<int, int> e{pi, pk};
-        for (int i : m_EMap[e])
-            m_Regions[i].AddVertex();
+        CountSample(pi, +1, C);
+        CountSample(pk, +1, C);
+        CountCouple(pi, pk, +1, C);
         return;
     }
 
-    // If all vertices belongs to different partitions, we add a vertex to all
-    // the regions containing at least one of those partitions
-    std::tuple<int, int, int> t{pi, pj, pk};
-    for (int i : m_TMap[t])
-        m_Regions[i].AddVertex();
+    // If all vertices belongs to different partitions, we count a vertex for
+    // the three partitions, for their couples and for their triple
+    CountSample(pi, +1, C);
+    CountSample(pj, +1, C);
+    CountSample(pk, +1, C);
+    CountCouple(pi, pj, +1, C);
+    CountCouple(pj, pk, +1, C);
+    CountCouple(pi, pk, +1, C);
+    if (m_VIdx[pi] == -1 || m_VIdx[pj] == -1 || m_VIdx[pk] == -1)
+        return;
+    const int* Idx = m_TIdx.Find(rmt::PackTriple(pi, pj, pk));
+    if (Idx != nullptr)
+        C.T[*Idx] += 1;
 }
 
 
@@ -237,39 +254,73 @@ const rmt::SurfaceRegion& rmt::RegionDictionary::GetRegion(size_t i) const
     return m_Regions[i];
 }
 
-bool rmt::RegionDictionary::IsClosed2Ball(size_t i) const
+int rmt::RegionDictionary::EulerCharacteristic(size_t i) const
 {
     CUTCheckLess(i, NumRegions());
-    return m_Regions[i].EulerCharacteristic() == 1;
+    std::tuple<int, int, int> T = m_Regions[i].GetSamples();
+    int pi = std::get<0>(T);
+    int pj = std::get<1>(T);
+    int pk = std::get<2>(T);
+
+    // Inclusion-exclusion over the samples of the region
+    const Counts& C = m_Counts[0];
+    int Chi = C.V[m_VIdx[pi]];
+    if (pj >= (int)m_VIdx.size())
+        return Chi;
+    Chi += C.V[m_VIdx[pj]];
+    Chi -= C.E[*m_EIdx.Find(rmt::PackPair(pi, pj))];
+    if (pk >= (int)m_VIdx.size())
+        return Chi;
+    Chi += C.V[m_VIdx[pk]];
+    Chi -= C.E[*m_EIdx.Find(rmt::PackPair(pi, pk))];
+    Chi -= C.E[*m_EIdx.Find(rmt::PackPair(pj, pk))];
+    Chi += C.T[*m_TIdx.Find(rmt::PackTriple(pi, pj, pk))];
+    return Chi;
+}
+
+bool rmt::RegionDictionary::IsClosed2Ball(size_t i) const
+{
+    return EulerCharacteristic(i) == 1;
 }
 
 
-void rmt::RegionDictionary::BuildRegionMaps()
+void rmt::RegionDictionary::BuildRegionMaps(int NumThreads)
 {
-    m_EMap.clear();
-    m_EMap.reserve(m_ESet.size());
-    for (auto e : m_ESet)
+    // Give a count to each sample, couple and triple of samples of the regions
+    for (const auto& Reg : m_Regions)
     {
-        m_EMap.emplace(e, std::vector<int>{});
-        std::vector<int>& Pe = m_EMap[e];
-        Pe.insert(Pe.end(), m_VMap[e.first].begin(), m_VMap[e.first].end());
-        Pe.insert(Pe.end(), m_VMap[e.second].begin(), m_VMap[e.second].end());
-        std::sort(Pe.begin(), Pe.end());
-        auto PeEnd = std::unique(Pe.begin(), Pe.end());
-        Pe.erase(PeEnd, Pe.end());
+        std::tuple<int, int, int> T = Reg.GetSamples();
+        for (int p : { std::get<0>(T), std::get<1>(T), std::get<2>(T) })
+        {
+            if (p < (int)m_VIdx.size() && m_VIdx[p] == -1)
+            {
+                m_VIdx[p] = m_VSamples.size();
+                m_VSamples.emplace_back(p);
+            }
+        }
     }
-    
-    m_TMap.clear();
-    m_TMap.reserve(m_TSet.size());
-    for (auto t : m_TSet)
+
+    // The couples and triples got their count with the regions
+    m_Counts.resize(std::max(NumThreads, 1));
+    for (Counts& C : m_Counts)
+    {
+        C.V.assign(m_VSamples.size(), 0);
+        C.E.assign(m_EIdx.Size(), 0);
+        C.T.assign(m_TIdx.Size(), 0);
+    }
+}
+
+void rmt::RegionDictionary::ReduceCounts()
+{
+    Counts& C0 = m_Counts[0];
+    for (size_t t = 1; t < m_Counts.size(); ++t)
     {
-        m_TMap.emplace(t, std::vector<int>{});
-        std::vector<int>& Pt = m_TMap[t];
-        Pt.insert(Pt.end(), m_VMap[std::get<0>(t)].begin(), m_VMap[std::get<0>(t)].end());
-        Pt.insert(Pt.end(), m_VMap[std::get<1>(t)].begin(), m_VMap[std::get<1>(t)].end());
-        Pt.insert(Pt.end(), m_VMap[std::get<2>(t)].begin(), m_VMap[std::get<2>(t)].end());
-        std::sort(Pt.begin(), Pt.end());
-        auto PtEnd = std::unique(Pt.begin(), Pt.end());
-        Pt.erase(PtEnd, Pt.end());
+        Counts& C = m_Counts[t];
+        for (size_t i = 0; i < C.V.size(); ++i)
+            C0.V[i] += std::exchange(C.V[i], 0);
+        for (size_t i = 0; i < C.E.size(); ++i)
+            C0.E[i] += std::exchange(C.E[i], 0);
+        for (size_t i = 0; i < C.T.size(); ++i)
+            C0.T[i] += std::exchange(C.T[i], 0);
     }
 }
\ No newline at end of file
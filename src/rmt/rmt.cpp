@@ -18,13 +18,13 @@ void rmt::Remesh(const Eigen::MatrixXd & Vin,
                  const Eigen::MatrixXi & Fin, 
                  int NSamples, 
                  Eigen::MatrixXd & Vout, 
-                 Eigen::MatrixXi & Fout)
+                 Eigen::MatrixXi & Fout,
+                 double Tolerance)
 {
     rmt::Mesh M(Vin, Fin);
     M.ComputeEdgesAndBoundaries();
     rmt::VoronoiPartitioning VPart(M);
-    while (VPart.NumSamples() < NSamples)
-        VPart.AddSample(VPart.FarthestVertex());
+    VPart.AddSamples(NSamples - VPart.NumSamples(), Tolerance);
     if (igl::is_edge_manifold(Fin) && igl::is_vertex_manifold(Fin))
     {
         rmt::FlatUnion FU(M, VPart);
@@ -43,13 +43,65 @@ void rmt::Remesh(const Eigen::MatrixXd & Vin,
                  int NSamples, 
                  Eigen::MatrixXd & Vout, 
                  Eigen::MatrixXi & Fout,
-                 Eigen::VectorXi & Vidx)
+                 Eigen::VectorXi & Vidx,
+                 double Tolerance)
+{
+    rmt::Mesh M(Vin, Fin);
+    M.ComputeEdgesAndBoundaries();
+    rmt::VoronoiPartitioning VPart(M);
+    VPart.AddSamples(NSamples - VPart.NumSamples(), Tolerance);
+    if (igl::is_edge_manifold(Fin) && igl::is_vertex_manifold(Fin))
+    {
+        rmt::FlatUnion FU(M, VPart);
+        do
+        {
+            FU.DetermineRegions();
+            FU.ComputeTopologies();
+        } while (!FU.FixIssues());
+    }
+    
+    rmt::MeshFromVoronoi(Vin, Fin, VPart, Vout, Fout);
+    Vidx.setZero(VPart.NumSamples());
+    for (int i = 0; i < Vidx.rows(); ++i)
+        Vidx[i] = VPart.GetSample(i);
+}
+
+void rmt::RemeshToRadius(const Eigen::MatrixXd & Vin, 
+                         const Eigen::MatrixXi & Fin, 
+                         double Radius, 
+                         Eigen::MatrixXd & Vout, 
+                         Eigen::MatrixXi & Fout,
+                         double Tolerance)
+{
+    rmt::Mesh M(Vin, Fin);
+    M.ComputeEdgesAndBoundaries();
+    rmt::VoronoiPartitioning VPart(M);
+    VPart.AddSamplesToRadius(Radius, M.NumVertices(), Tolerance);
+    if (igl::is_edge_manifold(Fin) && igl::is_vertex_manifold(Fin))
+    {
+        rmt::FlatUnion FU(M, VPart);
+        do
+        {
+            FU.DetermineRegions();
+            FU.ComputeTopologies();
+        } while (!FU.FixIssues());
+    }
+    
+    rmt::MeshFromVoronoi(Vin, Fin, VPart, Vout, Fout);
+}
+
+void rmt::RemeshToRadius(const Eigen::MatrixXd & Vin, 
+                         const Eigen::MatrixXi & Fin, 
+                         double Radius, 
+                         Eigen::MatrixXd & Vout, 
+                         Eigen::MatrixXi & Fout,
+                         Eigen::VectorXi & Vidx,
+                         double Tolerance)
 {
     rmt::Mesh M(Vin, Fin);
     M.ComputeEdgesAndBoundaries();
     rmt::VoronoiPartitioning VPart(M);
-    while (VPart.NumSamples() < NSamples)
-        VPart.AddSample(VPart.FarthestVertex());
+    VPart.AddSamplesToRadius(Radius, M.NumVertices(), Tolerance);
     if (igl::is_edge_manifold(Fin) && igl::is_vertex_manifold(Fin))
     {
         rmt::FlatUnion FU(M, VPart);
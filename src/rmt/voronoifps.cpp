@@ -10,21 +10,217 @@
  * @date        2024-01-15
  */
 #include <rmt/voronoifps.hpp>
+#include <rmt/parallel.hpp>
+#include <rmt/utils.hpp>
 #include <random>
-#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <tuple>
+
+
+namespace
+{
+
+// Maximum number of vertices in a leaf of the kd-tree
+constexpr int KdLeafSize = 16;
+
+// Header of the checkpoints, which differs with single precision distances
+#ifdef RMT_COMPACT_VORONOI
+constexpr char FileMagic[8] = { 'R', 'M', 'T', 'V', 'P', 'F', '0', '1' };
+#else
+constexpr char FileMagic[8] = { 'R', 'M', 'T', 'V', 'P', '0', '0', '1' };
+#endif
+
+/**
+ * @brief       Euclidean farthest point sampling backed by a kd-tree.
+ *
+ * @details     Each node of the tree keeps the largest squared distance of its vertices from the
+ *              samples, so inserting a sample only visits the nodes whose bounding box is closer
+ *              to the sample than their farthest vertex. Ties are broken by the smallest index.
+ */
+class EuclideanSampler
+{
+private:
+    struct Node
+    {
+        Eigen::Vector3d Min;
+        Eigen::Vector3d Max;
+        int Begin;
+        int End;
+        int Left;
+        int Right;
+        int Farthest;
+    };
+
+    std::vector<Node> m_Nodes;
+    std::vector<Eigen::Vector3d> m_Points;
+    std::vector<int> m_Index;
+    std::vector<double> m_Dists;
+
+    bool Precedes(int i, int j) const
+    {
+        return m_Dists[i] > m_Dists[j] || (m_Dists[i] == m_Dists[j] && m_Index[i] < m_Index[j]);
+    }
+
+    int Build(const Eigen::MatrixXd& V, int Begin, int End)
+    {
+        Eigen::Vector3d Min = V.row(m_Index[Begin]).transpose();
+        Eigen::Vector3d Max = Min;
+        for (int i = Begin + 1; i < End; ++i)
+        {
+            Min = Min.cwiseMin(V.row(m_Index[i]).transpose());
+            Max = Max.cwiseMax(V.row(m_Index[i]).transpose());
+        }
+
+        int Left = -1;
+        int Right = -1;
+        if (End - Begin > KdLeafSize)
+        {
+            int Axis;
+            (Max - Min).maxCoeff(&Axis);
+            int Mid = (Begin + End) / 2;
+            std::nth_element(m_Index.begin() + Begin, m_Index.begin() + Mid, m_Index.begin() + End, [&](int i, int j)
+            {
+                return V(i, Axis) < V(j, Axis) || (V(i, Axis) == V(j, Axis) && i < j);
+            });
+            Left = Build(V, Begin, Mid);
+            Right = Build(V, Mid, End);
+        }
+
+        m_Nodes.push_back({ Min, Max, Begin, End, Left, Right, Begin });
+        return m_Nodes.size() - 1;
+    }
+
+    void Insert(const Eigen::Vector3d& P, int n)
+    {
+        Node& Nd = m_Nodes[n];
+        double BoxDist = (P - P.cwiseMax(Nd.Min).cwiseMin(Nd.Max)).squaredNorm();
+        if (BoxDist >= m_Dists[Nd.Farthest])
+            return;
+
+        if (Nd.Left < 0)
+        {
+            Nd.Farthest = Nd.Begin;
+            for (int i = Nd.Begin; i < Nd.End; ++i)
+            {
+                m_Dists[i] = std::min(m_Dists[i], (m_Points[i] - P).squaredNorm());
+                if (Precedes(i, Nd.Farthest))
+                    Nd.Farthest = i;
+            }
+            return;
+        }
+
+        Insert(P, Nd.Left);
+        Insert(P, Nd.Right);
+        int l = m_Nodes[Nd.Left].Farthest;
+        int r = m_Nodes[Nd.Right].Farthest;
+        Nd.Farthest = Precedes(r, l) ? r : l;
+    }
+
+public:
+    EuclideanSampler(const Eigen::MatrixXd& V)
+    {
+        int N = V.rows();
+        m_Index.resize(N);
+        for (int i = 0; i < N; ++i)
+            m_Index[i] = i;
+        m_Nodes.reserve(2 * (N / KdLeafSize + 1));
+        Build(V, 0, N);
+
+        m_Points.resize(N);
+        for (int i = 0; i < N; ++i)
+            m_Points[i] = V.row(m_Index[i]).transpose();
+        m_Dists.assign(N, std::numeric_limits<double>::infinity());
+    }
+
+    // The root is the last node built
+    int FarthestVertex() const { return m_Index[m_Nodes.back().Farthest]; }
+    double FarthestDistance() const { return std::sqrt(m_Dists[m_Nodes.back().Farthest]); }
+
+    void AddSample(const Eigen::Vector3d& P) { Insert(P, m_Nodes.size() - 1); }
+};
+
+} // namespace
 
 rmt::VoronoiPartitioning::VoronoiPartitioning(const rmt::Mesh& M)
-    : m_G(M.GetVertices(), M.GetTriangles())
+    : VoronoiPartitioning(rmt::Graph(M.GetVertices(), M.GetTriangles()))
+{ }
+
+rmt::VoronoiPartitioning::VoronoiPartitioning(const rmt::Mesh& M, const std::vector<int>& Seeds, int NumThreads)
+    : VoronoiPartitioning(rmt::Graph(M.GetVertices(), M.GetTriangles(), NumThreads), Seeds, NumThreads)
+{ }
+
+rmt::VoronoiPartitioning::VoronoiPartitioning(rmt::Graph&& G)
+    : m_G(std::move(G))
 {
     std::mt19937 Eng(0);
-    std::uniform_int_distribution<int> Distr(0, M.NumVertices() - 1);
+    std::uniform_int_distribution<int> Distr(0, m_G.NumVertices() - 1);
     int FirstSample = Distr(Eng);
     m_Samples.emplace_back(FirstSample);
 
-    m_Partitions.setConstant(M.NumVertices(), 0);
-    m_G.DijkstraDistance(FirstSample, m_Distances);
+    m_Partitions.setConstant(m_G.NumVertices(), 0);
+    Eigen::VectorXd Distances;
+    m_G.DijkstraDistance(FirstSample, Distances, 0.0);
+    m_Distances = Distances.cast<rmt::SampleDistance>();
 
-    m_HDists = new cut::MinHeap(m_Distances.data(), M.NumVertices(), true);
+    BuildCells();
+}
+
+rmt::VoronoiPartitioning::VoronoiPartitioning(rmt::Graph&& G, const std::vector<int>& Seeds, int NumThreads)
+    : m_G(std::move(G))
+{
+    CUTAssert(!Seeds.empty());
+    for (int s : Seeds)
+    {
+        CUTCheckGEQ(s, 0);
+        CUTCheckLess(s, m_G.NumVertices());
+    }
+    m_Samples = Seeds;
+
+    Eigen::VectorXd Distances;
+    m_G.MultiSourceDijkstra(Seeds, Distances, m_Partitions, 0.0, NumThreads);
+    m_Distances = Distances.cast<rmt::SampleDistance>();
+    for (int i = 0; i < m_Partitions.rows(); ++i)
+    {
+        if (m_Partitions[i] == -1)
+            m_Partitions[i] = 0;
+    }
+
+    BuildCells();
+}
+
+rmt::VoronoiPartitioning::VoronoiPartitioning(const rmt::VoronoiPartitioning& VP)
+    : m_G(VP.m_G)
+{
+    m_Samples = VP.m_Samples;
+    m_Partitions = VP.m_Partitions;
+    m_Distances = VP.m_Distances;
+    m_CellVerts = VP.m_CellVerts;
+    m_CellSizes = VP.m_CellSizes;
+    m_CellFarthest = VP.m_CellFarthest;
+    m_HCells = VP.m_HCells;
+    m_ChangedCells = VP.m_ChangedCells;
+    m_CellChanged = VP.m_CellChanged;
+}
+
+rmt::VoronoiPartitioning& rmt::VoronoiPartitioning::operator=(const rmt::VoronoiPartitioning& VP)
+{
+    m_G = VP.m_G;
+    m_Samples = VP.m_Samples;
+    m_Partitions = VP.m_Partitions;
+    m_Distances = VP.m_Distances;
+    m_CellVerts = VP.m_CellVerts;
+    m_CellSizes = VP.m_CellSizes;
+    m_CellFarthest = VP.m_CellFarthest;
+    m_HCells = VP.m_HCells;
+    m_ChangedCells = VP.m_ChangedCells;
+    m_CellChanged = VP.m_CellChanged;
+
+    return *this;
 }
 
 rmt::VoronoiPartitioning::VoronoiPartitioning(rmt::VoronoiPartitioning&& VP)
@@ -33,8 +229,12 @@ rmt::VoronoiPartitioning::VoronoiPartitioning(rmt::VoronoiPartitioning&& VP)
     m_Samples = std::move(VP.m_Samples);
     m_Partitions = std::move(VP.m_Partitions);
     m_Distances = std::move(VP.m_Distances);
-    m_HDists = VP.m_HDists;
-    VP.m_HDists = nullptr;
+    m_CellVerts = std::move(VP.m_CellVerts);
+    m_CellSizes = std::move(VP.m_CellSizes);
+    m_CellFarthest = std::move(VP.m_CellFarthest);
+    m_HCells = std::move(VP.m_HCells);
+    m_ChangedCells = std::move(VP.m_ChangedCells);
+    m_CellChanged = std::move(VP.m_CellChanged);
 }
 
 rmt::VoronoiPartitioning& rmt::VoronoiPartitioning::operator=(rmt::VoronoiPartitioning&& VP)
@@ -43,17 +243,17 @@ rmt::VoronoiPartitioning& rmt::VoronoiPartitioning::operator=(rmt::VoronoiPartit
     m_Samples = std::move(VP.m_Samples);
     m_Partitions = std::move(VP.m_Partitions);
     m_Distances = std::move(VP.m_Distances);
-    m_HDists = VP.m_HDists;
-    VP.m_HDists = nullptr;
+    m_CellVerts = std::move(VP.m_CellVerts);
+    m_CellSizes = std::move(VP.m_CellSizes);
+    m_CellFarthest = std::move(VP.m_CellFarthest);
+    m_HCells = std::move(VP.m_HCells);
+    m_ChangedCells = std::move(VP.m_ChangedCells);
+    m_CellChanged = std::move(VP.m_CellChanged);
 
     return *this;
 }
 
-rmt::VoronoiPartitioning::~VoronoiPartitioning()
-{
-    if (m_HDists != nullptr)
-        delete m_HDists;
-}
+rmt::VoronoiPartitioning::~VoronoiPartitioning() { }
 
 
 
@@ -64,7 +264,7 @@ double rmt::VoronoiPartitioning::GetDistance(int i) const
     return m_Distances[i];
 }
 
-const Eigen::VectorXd& rmt::VoronoiPartitioning::GetDistances() const
+const rmt::DistanceVector& rmt::VoronoiPartitioning::GetDistances() const
 {
     return m_Distances;
 }
@@ -94,31 +294,64 @@ const std::vector<int>& rmt::VoronoiPartitioning::GetSamples() const
     return m_Samples;
 }
 
+const std::vector<int>& rmt::VoronoiPartitioning::GetCellVertices(int Cell) const
+{
+    CUTCheckGEQ(Cell, 0);
+    CUTCheckLess(Cell, NumSamples());
+    return m_CellVerts[Cell];
+}
+
+
+const std::vector<int>& rmt::VoronoiPartitioning::GetChangedCells() const
+{
+    return m_ChangedCells;
+}
+
+void rmt::VoronoiPartitioning::ClearChangedCells()
+{
+    for (int c : m_ChangedCells)
+        m_CellChanged[c] = false;
+    m_ChangedCells.clear();
+}
+
+void rmt::VoronoiPartitioning::MarkChanged(int Cell)
+{
+    if (Cell >= (int)m_CellChanged.size())
+        m_CellChanged.resize(Cell + 1, false);
+    if (m_CellChanged[Cell])
+        return;
+    m_CellChanged[Cell] = true;
+    m_ChangedCells.emplace_back(Cell);
+}
+
 
 int rmt::VoronoiPartitioning::FarthestVertex() const
 {
-    return (int)m_HDists->FindMin().second;
+    return m_CellFarthest[m_HCells.Top().second];
 }
 
-void rmt::VoronoiPartitioning::AddSample(int NewSample)
+double rmt::VoronoiPartitioning::CoveringRadius() const
+{
+    return m_HCells.Top().first;
+}
+
+void rmt::VoronoiPartitioning::GrowRegion(int NewSample, int Label, rmt::RadixHeapQueue& Frontier, std::vector<std::pair<int, int>>& Moved)
 {
-    std::priority_queue<std::pair<double, int>,
-                        std::vector<std::pair<double, int>>,
-                        std::greater<std::pair<double, int>>> Q;
+    // Only reads and writes the new cell and its one-ring, and leaves the cells untouched.
+    // Every vertex whose distance decreases moves to the new cell, and is reported once
+    // together with the cell it comes from.
+    Frontier.Clear();
+    Moved.emplace_back(NewSample, m_Partitions[NewSample]);
     m_Distances[NewSample]= 0;
-    m_Partitions[NewSample] = NumSamples();
-    Q.emplace(0, NewSample);
-    while (!Q.empty())
+    m_Partitions[NewSample] = Label;
+    Frontier.Push(0, NewSample);
+    while (!Frontier.Empty())
     {
-        std::pair<double, int> Next = Q.top();
-        Q.pop();
+        std::pair<double, int> Next = Frontier.Pop();
 
         int Cur = Next.second;
         double W = Next.first;
 
-        if (W < m_HDists->GetKey(Cur))
-            m_HDists->SetKey(Cur, W);
-
         int Deg = m_G.NumAdjacents(Cur);
         for (int j = 0; j < Deg; ++j)
         {
@@ -126,10 +359,486 @@ void rmt::VoronoiPartitioning::AddSample(int NewSample)
             if (m_Distances[Neig.first] <= W + Neig.second)
                 continue;
             m_Distances[Neig.first] = W + Neig.second;
-            Q.emplace(m_Distances[Neig.first], Neig.first);
-            m_Partitions[Neig.first] = NumSamples();
+            Frontier.Push(m_Distances[Neig.first], Neig.first);
+            if (m_Partitions[Neig.first] != Label)
+            {
+                Moved.emplace_back(Neig.first, m_Partitions[Neig.first]);
+                m_Partitions[Neig.first] = Label;
+            }
         }
     }
+}
+
+void rmt::VoronoiPartitioning::BuildCells()
+{
+    int NCells = NumSamples();
+    m_CellVerts.assign(NCells, std::vector<int>());
+    m_CellSizes.assign(NCells, 0);
+    m_CellFarthest.assign(NCells, -1);
+    m_HCells = rmt::IndexedMaxHeap();
+    m_ChangedCells.clear();
+    m_CellChanged.clear();
+
+    for (int i = 0; i < m_Partitions.rows(); ++i)
+        m_CellSizes[m_Partitions[i]]++;
+    for (int c = 0; c < NCells; ++c)
+        m_CellVerts[c].reserve(m_CellSizes[c]);
+    for (int i = 0; i < m_Partitions.rows(); ++i)
+        m_CellVerts[m_Partitions[i]].emplace_back(i);
+
+    for (int c = 0; c < NCells; ++c)
+    {
+        m_HCells.Push(std::numeric_limits<double>::infinity(), c);
+        UpdateCell(c);
+        MarkChanged(c);
+    }
+}
+
+void rmt::VoronoiPartitioning::UpdateCell(int Cell)
+{
+    // Drops the stale entries and finds the farthest vertex, ties broken by the smallest index
+    std::vector<int>& Verts = m_CellVerts[Cell];
+    int Far = -1;
+    size_t Size = 0;
+    for (int v : Verts)
+    {
+        if (m_Partitions[v] != Cell)
+            continue;
+        Verts[Size++] = v;
+        if (Far == -1 || m_Distances[v] > m_Distances[Far] || (m_Distances[v] == m_Distances[Far] && v < Far))
+            Far = v;
+    }
+    // Cells never grow after their creation, so the memory of the stale entries is released
+    Verts.resize(Size);
+    if (Verts.capacity() > 2 * Size + 16)
+        Verts.shrink_to_fit();
+
+    // Distances never increase, so the farthest distance of a cell can only decrease
+    m_CellFarthest[Cell] = Far;
+    m_HCells.DecreaseKey(Cell, Far == -1 ? -std::numeric_limits<double>::infinity() : m_Distances[Far]);
+}
+
+void rmt::VoronoiPartitioning::CommitCell(int Label, const std::vector<std::pair<int, int>>& Moved)
+{
+    // Only the cells that lost their farthest vertex change their maximum. The others are
+    // compacted when most of their entries are stale.
+    for (const auto& m : Moved)
+    {
+        int Old = m.second;
+        m_CellSizes[Old]--;
+        MarkChanged(Old);
+        if (m.first == m_CellFarthest[Old] || (int)m_CellVerts[Old].size() > 2 * m_CellSizes[Old] + 16)
+            UpdateCell(Old);
+    }
+
+    m_CellVerts.emplace_back();
+    m_CellVerts[Label].reserve(Moved.size());
+    for (const auto& m : Moved)
+        m_CellVerts[Label].emplace_back(m.first);
+    m_CellSizes.emplace_back(Moved.size());
+    m_CellFarthest.emplace_back(-1);
+    m_HCells.Push(std::numeric_limits<double>::infinity(), Label);
+    UpdateCell(Label);
+    MarkChanged(Label);
+}
+
+void rmt::VoronoiPartitioning::AddSample(int NewSample)
+{
+    m_Moved.clear();
+    GrowRegion(NewSample, NumSamples(), m_Frontier, m_Moved);
+    CommitCell(NumSamples(), m_Moved);
+    // The first samples move most of the mesh, the next ones only a few vertices
+    if (m_Moved.capacity() > 2 * m_Moved.size() + 1024)
+        m_Moved.shrink_to_fit();
 
     m_Samples.emplace_back(NewSample);
+}
+
+int rmt::VoronoiPartitioning::AddSamples(int Count, double Tolerance, int NumThreads)
+{
+    // A negative radius never stops the sampling, not even on coincident vertices
+    return Sample(Count, -1.0, Tolerance, NumThreads);
+}
+
+int rmt::VoronoiPartitioning::AddSamples(int Count, double Tolerance, rmt::ThreadPool& Pool)
+{
+    return Sample(Count, -1.0, Tolerance, Pool);
+}
+
+int rmt::VoronoiPartitioning::AddSamplesToRadius(double Radius, int MaxCount, double Tolerance, int NumThreads)
+{
+    CUTCheckGEQ(Radius, 0.0);
+    return Sample(MaxCount, Radius, Tolerance, NumThreads);
+}
+
+int rmt::VoronoiPartitioning::AddSamplesToRadius(double Radius, int MaxCount, double Tolerance, rmt::ThreadPool& Pool)
+{
+    CUTCheckGEQ(Radius, 0.0);
+    return Sample(MaxCount, Radius, Tolerance, Pool);
+}
+
+int rmt::VoronoiPartitioning::Sample(int Count, double Radius, double Tolerance, int NumThreads)
+{
+    // The exact sampling is sequential and needs no threads
+    rmt::ThreadPool Pool(Tolerance > 0.0 ? rmt::NumThreadsFor(NumThreads, m_G.NumVertices()) : 1);
+    return Sample(Count, Radius, Tolerance, Pool);
+}
+
+int rmt::VoronoiPartitioning::Sample(int Count, double Radius, double Tolerance, rmt::ThreadPool& Pool)
+{
+    CUTCheckGEQ(Tolerance, 0.0);
+    CUTCheckLess(Tolerance, 1.0);
+
+    int N = m_G.NumVertices();
+    int FirstNew = NumSamples();
+    int Target = std::min(FirstNew + std::max(Count, 0), N);
+
+    // Exact farthest point sampling
+    if (Tolerance == 0.0)
+    {
+        while (NumSamples() < Target && CoveringRadius() > Radius)
+            AddSample(FarthestVertex());
+        return NumSamples() - FirstNew;
+    }
+
+    double MaxEdge = 0.0;
+    for (int i = 0; i < N; ++i)
+    {
+        for (int j = 0; j < m_G.NumAdjacents(i); ++j)
+            MaxEdge = std::max(MaxEdge, m_G.GetWeight(i, j));
+    }
+
+    int NThreads = Pool.NumThreads();
+    std::vector<rmt::RadixHeapQueue> ThreadFrontiers(NThreads);
+    std::vector<std::vector<std::pair<int, int>>> BatchMoved;
+    std::vector<std::pair<double, int>> Candidates;
+    rmt::FlatHashMap<rmt::PackedTriple, std::vector<int>> Grid;
+    std::vector<int> Batch;
+
+    while (NumSamples() < Target && CoveringRadius() > Radius)
+    {
+        int First = FarthestVertex();
+        double Covering = m_Distances[First];
+        double Threshold = (1.0 - Tolerance) * Covering;
+        double Separation = 2.0 * (Covering + MaxEdge);
+        int MaxBatch = Target - NumSamples();
+
+        Batch.clear();
+        Batch.emplace_back(First);
+        if (MaxBatch > 1 && Separation > 0.0)
+        {
+            // Two vertices of the same cell are closer than the separation, so at most one
+            // of them can be accepted: only the farthest vertex of each cell is a candidate
+            Candidates.clear();
+            for (int c = 0; c < NumSamples(); ++c)
+            {
+                int Far = m_CellFarthest[c];
+                if (Far != -1 && Far != First && m_Distances[Far] > 0.0 && m_Distances[Far] > Radius && m_Distances[Far] >= Threshold)
+                    Candidates.emplace_back(-m_Distances[Far], Far);
+            }
+            std::sort(Candidates.begin(), Candidates.end());
+
+            // Greedy selection of well separated candidates, using a grid with cells as large as the separation.
+            // Cell indices are clamped, with room for the neighboring cells: clamping never separates two
+            // close vertices, it only merges far away cells.
+            constexpr double MaxCell = std::numeric_limits<int>::max() / 2;
+            auto CellOf = [&](int v)
+            {
+                Eigen::Vector3d P = (m_G.GetVertex(v).cast<double>() / Separation).array().floor().max(-MaxCell).min(MaxCell);
+                return Eigen::Vector3i((int)P[0], (int)P[1], (int)P[2]);
+            };
+            auto Key = [](const Eigen::Vector3i& Cell) { return rmt::PackTriple(Cell[0], Cell[1], Cell[2]); };
+            Grid.Clear(Grid.Size());
+            Grid[Key(CellOf(First))].emplace_back(First);
+            for (size_t c = 0; c < Candidates.size() && (int)Batch.size() < MaxBatch; ++c)
+            {
+                int v = Candidates[c].second;
+                Eigen::Vector3i Cell = CellOf(v);
+                bool Separated = true;
+                for (int dx = -1; dx <= 1 && Separated; ++dx)
+                for (int dy = -1; dy <= 1 && Separated; ++dy)
+                for (int dz = -1; dz <= 1 && Separated; ++dz)
+                {
+                    const std::vector<int>* Near = Grid.Find(rmt::PackTriple(Cell[0] + dx, Cell[1] + dy, Cell[2] + dz));
+                    if (Near == nullptr)
+                        continue;
+                    for (int u : *Near)
+                    {
+                        if ((m_G.GetVertex(u) - m_G.GetVertex(v)).cast<double>().norm() < Separation)
+                        {
+                            Separated = false;
+                            break;
+                        }
+                    }
+                }
+                if (!Separated)
+                    continue;
+                Grid[Key(Cell)].emplace_back(v);
+                Batch.emplace_back(v);
+            }
+        }
+
+        // Grow the disjoint cells concurrently
+        int Label = NumSamples();
+        if (BatchMoved.size() < Batch.size())
+            BatchMoved.resize(Batch.size());
+        std::atomic<int> NextSample(0);
+        Pool.Run([&](int ThreadID)
+        {
+            for (int b = NextSample++; b < (int)Batch.size(); b = NextSample++)
+            {
+                BatchMoved[b].clear();
+                GrowRegion(Batch[b], Label + b, ThreadFrontiers[ThreadID], BatchMoved[b]);
+            }
+        });
+        for (int b = 0; b < (int)Batch.size(); ++b)
+            CommitCell(Label + b, BatchMoved[b]);
+        m_Samples.insert(m_Samples.end(), Batch.begin(), Batch.end());
+    }
+
+    return NumSamples() - FirstNew;
+}
+
+bool rmt::VoronoiPartitioning::Save(const std::string& Filename) const
+{
+    return rmt::WriteFileSafely(Filename, [&](std::ostream& Stream) { return Save(Stream); });
+}
+
+bool rmt::VoronoiPartitioning::Load(const std::string& Filename)
+{
+    std::ifstream Stream(Filename, std::ios::binary);
+    if (!Stream.is_open())
+        return false;
+    return Load(Stream);
+}
+
+bool rmt::VoronoiPartitioning::Save(std::ostream& Stream) const
+{
+    int NVerts = m_Partitions.rows();
+    int NSamples = NumSamples();
+    rmt::WriteAlignmentPadding(Stream);
+    Stream.write(FileMagic, sizeof(FileMagic));
+    Stream.write((const char*)&NVerts, sizeof(int));
+    Stream.write((const char*)&NSamples, sizeof(int));
+    rmt::WriteAlignmentPadding(Stream);
+    Stream.write((const char*)m_Samples.data(), sizeof(int) * NSamples);
+    rmt::WriteAlignmentPadding(Stream);
+    Stream.write((const char*)m_Partitions.data(), sizeof(int) * NVerts);
+    rmt::WriteAlignmentPadding(Stream);
+    Stream.write((const char*)m_Distances.data(), sizeof(rmt::SampleDistance) * NVerts);
+
+    return Stream.good();
+}
+
+bool rmt::VoronoiPartitioning::Load(std::istream& Stream)
+{
+    char Magic[sizeof(FileMagic)];
+    int NVerts;
+    int NSamples;
+    rmt::SkipAlignmentPadding(Stream);
+    Stream.read(Magic, sizeof(Magic));
+    Stream.read((char*)&NVerts, sizeof(int));
+    Stream.read((char*)&NSamples, sizeof(int));
+    if (!Stream.good() || std::memcmp(Magic, FileMagic, sizeof(FileMagic)) != 0 ||
+        NVerts != m_G.NumVertices() || NSamples <= 0 || NSamples > NVerts)
+        return false;
+
+    std::vector<int> Samples(NSamples);
+    Eigen::VectorXi Partitions(NVerts);
+    rmt::DistanceVector Distances(NVerts);
+    rmt::SkipAlignmentPadding(Stream);
+    Stream.read((char*)Samples.data(), sizeof(int) * NSamples);
+    rmt::SkipAlignmentPadding(Stream);
+    Stream.read((char*)Partitions.data(), sizeof(int) * NVerts);
+    rmt::SkipAlignmentPadding(Stream);
+    Stream.read((char*)Distances.data(), sizeof(rmt::SampleDistance) * NVerts);
+    if (!Stream.good())
+        return false;
+
+    // The state is left untouched by a corrupted checkpoint: samples must be distinct vertices,
+    // each one in its own partition, and the distances finite and non-negative
+    if (Partitions.minCoeff() < 0 || Partitions.maxCoeff() >= NSamples)
+        return false;
+    std::vector<bool> IsSample(NVerts, false);
+    for (int i = 0; i < NSamples; i++)
+    {
+        int s = Samples[i];
+        if (s < 0 || s >= NVerts || IsSample[s] || Partitions[s] != i)
+            return false;
+        IsSample[s] = true;
+    }
+    for (int i = 0; i < NVerts; i++)
+    {
+        if (!std::isfinite(Distances[i]) || !(Distances[i] >= 0))
+            return false;
+    }
+
+    m_Samples = std::move(Samples);
+    m_Partitions = std::move(Partitions);
+    m_Distances = std::move(Distances);
+    BuildCells();
+
+    return true;
+}
+
+rmt::VoronoiPartitioning rmt::VoronoiPartitioning::Hierarchical(const rmt::Mesh& M, int NumSamples,
+                                                                double CoarseFraction, int NumThreads)
+{
+    CUTCheckGEQ(CoarseFraction, 0.0);
+    CUTAssert(CoarseFraction <= 1.0);
+    const int ProxyNodesPerSample = 16;
+
+    rmt::Graph G(M.GetVertices(), M.GetTriangles(), NumThreads);
+    int N = G.NumVertices();
+    NumSamples = std::min(std::max(NumSamples, 1), N);
+    int NCoarse = CoarseFraction * NumSamples;
+    long long NProxy = (long long)NCoarse * ProxyNodesPerSample;
+    if (NCoarse < 2 || 2 * NProxy > N)
+    {
+        rmt::VoronoiPartitioning VPart(std::move(G));
+        VPart.AddSamples(NumSamples - 1, 0.0);
+        return VPart;
+    }
+
+    // Voxels with about NProxy of them intersecting the surface
+    double VoxelSize = G.MeanEdgeLength() * std::sqrt((double)N / NProxy);
+    Eigen::MatrixXi Voxels(N, 3);
+    for (int i = 0; i < N; ++i)
+    {
+        Eigen::Vector3d P = G.GetVertex(i).cast<double>() / VoxelSize;
+        Voxels.row(i) << (int)std::floor(P[0]), (int)std::floor(P[1]), (int)std::floor(P[2]);
+    }
+
+    // Clusters are the pieces of the mesh connected inside each voxel, found with a union-find
+    std::vector<int> Clusters(N);
+    for (int i = 0; i < N; ++i)
+        Clusters[i] = i;
+    auto Find = [&](int i)
+    {
+        while (Clusters[i] != i)
+        {
+            Clusters[i] = Clusters[Clusters[i]];
+            i = Clusters[i];
+        }
+        return i;
+    };
+    for (int i = 0; i < N; ++i)
+    {
+        for (int j = 0; j < G.NumAdjacents(i); ++j)
+        {
+            int k = G.GetNeighbor(i, j);
+            if (i > k || Voxels.row(i) != Voxels.row(k))
+                continue;
+            int ri = Find(i);
+            int rk = Find(k);
+            if (ri != rk)
+                Clusters[std::max(ri, rk)] = std::min(ri, rk);
+        }
+    }
+
+    // Parents precede their children, so a single pass flattens the trees
+    for (int i = 0; i < N; ++i)
+        Clusters[i] = Clusters[Clusters[i]];
+    // Roots are the smallest vertices of their cluster, so they are labeled before the other vertices
+    std::vector<int> ClusterSizes;
+    for (int i = 0; i < N; ++i)
+    {
+        if (Clusters[i] == i)
+        {
+            Clusters[i] = ClusterSizes.size();
+            ClusterSizes.emplace_back(0);
+        }
+        else
+            Clusters[i] = Clusters[Clusters[i]];
+        ClusterSizes[Clusters[i]]++;
+    }
+    int NClusters = ClusterSizes.size();
+
+    // Each cluster is represented by its vertex closest to the centroid
+    Eigen::MatrixXd Centroids;
+    Centroids.setZero(NClusters, 3);
+    for (int i = 0; i < N; ++i)
+        Centroids.row(Clusters[i]) += G.GetVertex(i).cast<double>().transpose() / ClusterSizes[Clusters[i]];
+    std::vector<int> Reps(NClusters, -1);
+    std::vector<double> RepDists(NClusters, std::numeric_limits<double>::infinity());
+    for (int i = 0; i < N; ++i)
+    {
+        int c = Clusters[i];
+        double D = (G.GetVertex(i).cast<double>().transpose() - Centroids.row(c)).squaredNorm();
+        if (D < RepDists[c])
+        {
+            Reps[c] = i;
+            RepDists[c] = D;
+        }
+    }
+
+    // Proxy graph, with an edge between two clusters if any of their vertices are adjacent.
+    // The vertices are grouped by cluster, so that each proxy edge is emitted only once.
+    Eigen::MatrixXd ProxyV(NClusters, 3);
+    for (int c = 0; c < NClusters; ++c)
+        ProxyV.row(c) = G.GetVertex(Reps[c]).cast<double>().transpose();
+    std::vector<int> MemberIdxs(NClusters + 1, 0);
+    for (int c = 0; c < NClusters; ++c)
+        MemberIdxs[c + 1] = MemberIdxs[c] + ClusterSizes[c];
+    std::vector<int> Members(N);
+    {
+        std::vector<int> Next(MemberIdxs.begin(), MemberIdxs.end() - 1);
+        for (int i = 0; i < N; ++i)
+            Members[Next[Clusters[i]]++] = i;
+    }
+    std::vector<int> Stamps(NClusters, -1);
+    std::vector<std::pair<int, int>> Edges;
+    for (int ci = 0; ci < NClusters; ++ci)
+    {
+        for (int m = MemberIdxs[ci]; m < MemberIdxs[ci + 1]; ++m)
+        {
+            int i = Members[m];
+            for (int j = 0; j < G.NumAdjacents(i); ++j)
+            {
+                int ck = Clusters[G.GetNeighbor(i, j)];
+                if (ci >= ck || Stamps[ck] == ci)
+                    continue;
+                Stamps[ck] = ci;
+                Edges.emplace_back(ci, ck);
+            }
+        }
+    }
+    std::vector<int>().swap(Members);
+    std::vector<int>().swap(Stamps);
+    rmt::VoronoiPartitioning Proxy(rmt::Graph(ProxyV, Edges));
+    std::vector<std::pair<int, int>>().swap(Edges);
+    Proxy.AddSamples(NCoarse - 1, 0.0);
+
+    // Lift the coarse samples and continue on the mesh
+    std::vector<int> Seeds;
+    Seeds.reserve(Proxy.NumSamples());
+    for (int s : Proxy.GetSamples())
+        Seeds.emplace_back(Reps[s]);
+    rmt::VoronoiPartitioning VPart(std::move(G), Seeds, NumThreads);
+    VPart.AddSamples(NumSamples - VPart.NumSamples(), 0.0);
+    return VPart;
+}
+
+rmt::VoronoiPartitioning rmt::VoronoiPartitioning::Euclidean(const rmt::Mesh& M, int NumSamples, int NumThreads)
+{
+    int N = M.NumVertices();
+    NumSamples = std::min(std::max(NumSamples, 1), N);
+
+    // Same first sample as the geodesic sampling
+    std::mt19937 Eng(0);
+    std::uniform_int_distribution<int> Distr(0, N - 1);
+    std::vector<int> Seeds;
+    Seeds.reserve(NumSamples);
+    Seeds.emplace_back(Distr(Eng));
+
+    EuclideanSampler Sampler(M.GetVertices());
+    Sampler.AddSample(M.GetVertices().row(Seeds[0]).transpose());
+    // Vertices at zero distance coincide with a sample
+    while ((int)Seeds.size() < NumSamples && Sampler.FarthestDistance() > 0.0)
+    {
+        Seeds.emplace_back(Sampler.FarthestVertex());
+        Sampler.AddSample(M.GetVertices().row(Seeds.back()).transpose());
+    }
+
+    return rmt::VoronoiPartitioning(rmt::Graph(M.GetVertices(), M.GetTriangles(), NumThreads), Seeds, NumThreads);
 }
\ No newline at end of file